@@ -0,0 +1,274 @@
+#include "src/affine.hpp"
+#include "src/delaunay.hpp"
+#include "src/enclosing_circle.hpp"
+#include "src/hull.hpp"
+#include "src/parallel.hpp"
+#include "src/plane.hpp"
+#include "src/rtree.hpp"
+#include "src/spatial_hash.hpp"
+#include "src/spatial_sort.hpp"
+#include "src/trapezoid_map.hpp"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Arguments are {log10 of the input size, distribution, threads}; threads
+// 0 means all hardware threads. The largest size defaults to 10^8 for the
+// linear kernels and 10^6 for the structures; PLANE_BENCH_MAX_LOG10
+// lowers both caps.
+using namespace plane;
+
+namespace {
+enum Distribution { Uniform, Clustered, Degenerate };
+
+const char* name(int dist) {
+  switch (dist) {
+  case Uniform:
+    return "uniform";
+  case Clustered:
+    return "clustered";
+  default:
+    return "degenerate";
+  }
+}
+
+// Degenerate inputs lie on a line up to rounding-level noise.
+std::vector<Point> make_points(size_t n, int dist, unsigned seed = 1) {
+  std::mt19937_64 gen(seed);
+  std::uniform_real_distribution<double> unit(0, 1);
+  std::normal_distribution<double> spread(0, 0.01);
+  std::vector<Point> points(n);
+  std::vector<Point> centers(64);
+  for (auto& c : centers)
+    c = Point{unit(gen), unit(gen)};
+  for (auto& p : points) {
+    if (dist == Uniform) {
+      p = Point{unit(gen), unit(gen)};
+    } else if (dist == Clustered) {
+      const Point& c = centers[gen() % centers.size()];
+      p = Point{c.x + spread(gen), c.y + spread(gen)};
+    } else {
+      double t = unit(gen);
+      p = Point{t, 0.5 * t + 1e-12 * unit(gen)};
+    }
+  }
+  return points;
+}
+
+// Degenerate lines are nearly parallel to each other.
+std::vector<Line> make_lines(size_t n, int dist, unsigned seed = 2) {
+  auto starts = make_points(n, dist == Degenerate ? Uniform : dist, seed);
+  std::mt19937_64 gen(seed);
+  std::uniform_real_distribution<double> angle(0, 6.283185307179586);
+  std::uniform_real_distribution<double> tiny(-1e-9, 1e-9);
+  std::vector<Line> lines;
+  lines.reserve(n);
+  for (auto& s : starts) {
+    double a = dist == Degenerate ? 0.3 + tiny(gen) : angle(gen);
+    lines.push_back(Line(s, Vector{std::cos(a), std::sin(a)}));
+  }
+  return lines;
+}
+
+std::vector<Segment> make_edges(size_t n, int dist) {
+  auto points = make_points(n, dist);
+  Delaunay d(points, lib::hardware_threads());
+  std::vector<Segment> edges;
+  auto& tris = d.triangles();
+  auto& half = d.halfedges();
+  for (uint32_t e = 0; e < tris.size(); e++)
+    if (half[e] == Delaunay::npos || half[e] < e)
+      edges.push_back(
+          {points[tris[e]], points[tris[Delaunay::next_halfedge(e)]]});
+  return edges;
+}
+
+size_t size_of(const benchmark::State& state) {
+  return static_cast<size_t>(std::pow(10, state.range(0)));
+}
+
+unsigned threads_of(const benchmark::State& state) {
+  return static_cast<unsigned>(state.range(2));
+}
+
+void finish(benchmark::State& state, size_t items) {
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * items));
+  state.SetLabel(name(static_cast<int>(state.range(1))));
+}
+
+void sizes(benchmark::internal::Benchmark* b, int max_log10,
+           std::vector<int64_t> threads) {
+  if (const char* env = std::getenv("PLANE_BENCH_MAX_LOG10"))
+    max_log10 = std::min(max_log10, std::atoi(env));
+  std::vector<int64_t> logs;
+  for (int64_t e = 3; e <= max_log10; e++)
+    logs.push_back(e);
+  b->ArgsProduct({logs, {Uniform, Clustered, Degenerate}, threads})
+      ->ArgNames({"log10n", "dist", "threads"})
+      ->Unit(benchmark::kMillisecond)
+      ->UseRealTime();
+}
+
+void linear(benchmark::internal::Benchmark* b) { sizes(b, 8, {1}); }
+void linear_parallel(benchmark::internal::Benchmark* b) {
+  sizes(b, 8, {1, 0});
+}
+void structure(benchmark::internal::Benchmark* b) { sizes(b, 6, {1}); }
+void structure_parallel(benchmark::internal::Benchmark* b) {
+  sizes(b, 6, {1, 0});
+}
+} // namespace
+
+static void BM_VectorOps(benchmark::State& state) {
+  auto points = make_points(size_of(state), static_cast<int>(state.range(1)));
+  for (auto _ : state) {
+    double dot = 0, cross = 0;
+    for (size_t i = 1; i < points.size(); i++) {
+      Vector d = points[i] - points[i - 1];
+      dot += d * d;
+      cross += d.cross(points[i] - points[0]);
+    }
+    benchmark::DoNotOptimize(dot);
+    benchmark::DoNotOptimize(cross);
+  }
+  finish(state, points.size());
+}
+BENCHMARK(BM_VectorOps)->Apply(linear);
+
+static void BM_LineIntersection(benchmark::State& state) {
+  auto lines = make_lines(size_of(state), static_cast<int>(state.range(1)));
+  Line probe(Point{0.5, 0.5}, Vector{1, 0.31});
+  for (auto _ : state) {
+    size_t hits = 0;
+    for (auto& l : lines)
+      hits += probe.intersection(l).has_value();
+    benchmark::DoNotOptimize(hits);
+  }
+  finish(state, lines.size());
+}
+BENCHMARK(BM_LineIntersection)->Apply(linear);
+
+// The batched kernel over implicit lines, split across threads.
+static void BM_ImplicitIntersectionBatch(benchmark::State& state) {
+  auto lines = make_lines(size_of(state), static_cast<int>(state.range(1)));
+  std::vector<ImplicitLine> implicit;
+  implicit.reserve(lines.size());
+  for (auto& l : lines)
+    implicit.emplace_back(l);
+  std::vector<Point> out(lines.size());
+  ImplicitLine probe(Line(Point{0.5, 0.5}, Vector{1, 0.31}));
+  std::span<const ImplicitLine> in(implicit);
+  for (auto _ : state) {
+    lib::parallel_for(
+        in.size(),
+        [&](size_t begin, size_t end) {
+          probe.intersection(in.subspan(begin, end - begin),
+                             std::span(out).subspan(begin, end - begin));
+        },
+        threads_of(state));
+    benchmark::ClobberMemory();
+  }
+  finish(state, lines.size());
+}
+BENCHMARK(BM_ImplicitIntersectionBatch)->Apply(linear_parallel);
+
+static void BM_AffineApply(benchmark::State& state) {
+  auto points = make_points(size_of(state), static_cast<int>(state.range(1)));
+  Affine2D t = Affine2D::rotation(0.3).then(Affine2D::translation({1, 2}));
+  for (auto _ : state) {
+    t.apply(std::span<Point>(points), threads_of(state));
+    benchmark::ClobberMemory();
+  }
+  finish(state, points.size());
+}
+BENCHMARK(BM_AffineApply)->Apply(linear_parallel);
+
+static void BM_SpatialSort(benchmark::State& state) {
+  auto points = make_points(size_of(state), static_cast<int>(state.range(1)));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(
+        spatial_order(points, Curve::Hilbert, threads_of(state)));
+  finish(state, points.size());
+}
+BENCHMARK(BM_SpatialSort)->Apply(linear_parallel);
+
+static void BM_ConvexHull(benchmark::State& state) {
+  auto points = make_points(size_of(state), static_cast<int>(state.range(1)));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(convex_hull(points));
+  finish(state, points.size());
+}
+BENCHMARK(BM_ConvexHull)->Apply(linear);
+
+static void BM_EnclosingCircle(benchmark::State& state) {
+  auto points = make_points(size_of(state), static_cast<int>(state.range(1)));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(min_enclosing_circle(points));
+  finish(state, points.size());
+}
+BENCHMARK(BM_EnclosingCircle)->Apply(linear);
+
+static void BM_Delaunay(benchmark::State& state) {
+  auto points = make_points(size_of(state), static_cast<int>(state.range(1)));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(Delaunay(points, threads_of(state)));
+  finish(state, points.size());
+}
+BENCHMARK(BM_Delaunay)->Apply(structure_parallel);
+
+static void BM_SpatialHashQuery(benchmark::State& state) {
+  auto points = make_points(size_of(state), static_cast<int>(state.range(1)));
+  auto queries = make_points(points.size(), Uniform, 7);
+  double radius = 1 / std::sqrt(double(points.size()));
+  SpatialHash hash(2 * radius);
+  hash.rebuild(points);
+  for (auto _ : state) {
+    size_t found = 0;
+    for (auto& q : queries)
+      hash.for_each_in_radius(q, radius, [&found](auto&&...) { found++; });
+    benchmark::DoNotOptimize(found);
+  }
+  finish(state, queries.size());
+}
+BENCHMARK(BM_SpatialHashQuery)->Apply(structure);
+
+static void BM_RTreeBuild(benchmark::State& state) {
+  auto edges = make_edges(size_of(state), static_cast<int>(state.range(1)));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(
+        RTree<Segment>(std::span<const Segment>(edges), threads_of(state)));
+  finish(state, edges.size());
+}
+BENCHMARK(BM_RTreeBuild)->Apply(structure_parallel);
+
+static void BM_RTreeNearest(benchmark::State& state) {
+  auto edges = make_edges(size_of(state), static_cast<int>(state.range(1)));
+  auto queries = make_points(size_of(state), Uniform, 7);
+  RTree<Segment> tree(std::span<const Segment>(edges), lib::hardware_threads());
+  for (auto _ : state)
+    benchmark::DoNotOptimize(tree.batch_nearest(queries, threads_of(state)));
+  finish(state, queries.size());
+}
+BENCHMARK(BM_RTreeNearest)->Apply(structure_parallel);
+
+static void BM_TrapezoidMapBuild(benchmark::State& state) {
+  auto edges = make_edges(size_of(state), static_cast<int>(state.range(1)));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(TrapezoidMap(edges));
+  finish(state, edges.size());
+}
+BENCHMARK(BM_TrapezoidMapBuild)->Apply(structure);
+
+static void BM_TrapezoidMapLocate(benchmark::State& state) {
+  auto edges = make_edges(size_of(state), static_cast<int>(state.range(1)));
+  auto queries = make_points(size_of(state), Uniform, 7);
+  TrapezoidMap map(edges);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(map.batch_locate(queries, threads_of(state)));
+  finish(state, queries.size());
+}
+BENCHMARK(BM_TrapezoidMapLocate)->Apply(structure_parallel);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,133 @@
+#pragma once
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "plane.hpp"
+#include <cmath>
+#include <concepts>
+#include <optional>
+#include <span>
+#include <stdexcept>
+
+namespace plane {
+// Row-major [a b tx; c d ty; 0 0 1], the last row is implicit.
+template <std::floating_point S>
+struct BasicAffine2D {
+  S a, b, tx;
+  S c, d, ty;
+
+  static constexpr BasicAffine2D identity() { return {1, 0, 0, 0, 1, 0}; }
+  static constexpr BasicAffine2D translation(const BasicVector<S>& v) {
+    return {1, 0, v.x, 0, 1, v.y};
+  }
+  static constexpr BasicAffine2D scale(S sx, S sy) {
+    return {sx, 0, 0, 0, sy, 0};
+  }
+  static BasicAffine2D rotation(S angle) {
+    S cos = std::cos(angle), sin = std::sin(angle);
+    return {cos, -sin, 0, sin, cos, 0};
+  }
+  static BasicAffine2D rotation(S angle, const BasicPoint<S>& center) {
+    return translation(center) * rotation(angle) *
+           translation(BasicVector<S>::zero() - center);
+  }
+
+  explicit BasicAffine2D(const Matrix<S>& m) {
+    if (m.rows() != 3 || m.cols() != 3)
+      throw std::invalid_argument("affine transform requires a 3x3 matrix");
+    if (!partial_eq(m[2][0], S(0)) || !partial_eq(m[2][1], S(0)) ||
+        !partial_eq(m[2][2], S(1)))
+      throw std::invalid_argument("matrix is not an affine transform");
+    a = m[0][0], b = m[0][1], tx = m[0][2];
+    c = m[1][0], d = m[1][1], ty = m[1][2];
+  }
+  constexpr BasicAffine2D(S a, S b, S tx, S c, S d, S ty)
+      : a(a), b(b), tx(tx), c(c), d(d), ty(ty) {}
+
+  Matrix<S> matrix() const {
+    Matrix<S> m(S(0), 3, 3);
+    m[0][0] = a, m[0][1] = b, m[0][2] = tx;
+    m[1][0] = c, m[1][1] = d, m[1][2] = ty;
+    m[2][2] = 1;
+    return m;
+  }
+
+  // (*this * rhs) applies rhs first.
+  constexpr BasicAffine2D operator*(const BasicAffine2D& rhs) const {
+    return {a * rhs.a + b * rhs.c,  a * rhs.b + b * rhs.d,
+            a * rhs.tx + b * rhs.ty + tx,
+            c * rhs.a + d * rhs.c,  c * rhs.b + d * rhs.d,
+            c * rhs.tx + d * rhs.ty + ty};
+  }
+  constexpr BasicAffine2D& operator*=(const BasicAffine2D& rhs) {
+    return *this = *this * rhs;
+  }
+  constexpr BasicAffine2D then(const BasicAffine2D& next) const {
+    return next * *this;
+  }
+  constexpr bool operator==(const BasicAffine2D& o) const {
+    return partial_eq(a, o.a) && partial_eq(b, o.b) && partial_eq(tx, o.tx) &&
+           partial_eq(c, o.c) && partial_eq(d, o.d) && partial_eq(ty, o.ty);
+  }
+
+  constexpr S determinant() const { return a * d - b * c; }
+  constexpr std::optional<BasicAffine2D> inverse() const {
+    S det = determinant();
+    if (partial_eq(det, S(0)))
+      return std::nullopt;
+    S ia = d / det, ib = -b / det, ic = -c / det, id = a / det;
+    return BasicAffine2D(ia, ib, -(ia * tx + ib * ty), ic, id,
+                         -(ic * tx + id * ty));
+  }
+
+  constexpr BasicPoint<S> apply(const BasicPoint<S>& p) const {
+    return {a * p.x + b * p.y + tx, c * p.x + d * p.y + ty};
+  }
+  constexpr BasicVector<S> apply(const BasicVector<S>& v) const {
+    return {a * v.x + b * v.y, c * v.x + d * v.y};
+  }
+
+  void apply(std::span<const BasicPoint<S>> in, std::span<BasicPoint<S>> out,
+             unsigned threads = 0) const {
+    if (in.size() != out.size())
+      throw std::invalid_argument("input and output sizes differ");
+    lib::parallel_for(
+        in.size(),
+        [this, in, out](size_t begin, size_t end) {
+          const S a = this->a, b = this->b, tx = this->tx, c = this->c,
+                  d = this->d, ty = this->ty;
+          const BasicPoint<S>* src = in.data();
+          BasicPoint<S>* dst = out.data();
+          for (size_t i = begin; i < end; i++) {
+            S x = src[i].x, y = src[i].y;
+            dst[i].x = a * x + b * y + tx;
+            dst[i].y = c * x + d * y + ty;
+          }
+        },
+        threads);
+  }
+  void apply(std::span<BasicPoint<S>> points, unsigned threads = 0) const {
+    apply(std::span<const BasicPoint<S>>(points), points, threads);
+  }
+
+  void apply(std::span<S> xs, std::span<S> ys, unsigned threads = 0) const {
+    if (xs.size() != ys.size())
+      throw std::invalid_argument("coordinate arrays differ in size");
+    lib::parallel_for(
+        xs.size(),
+        [this, xs, ys](size_t begin, size_t end) {
+          const S a = this->a, b = this->b, tx = this->tx, c = this->c,
+                  d = this->d, ty = this->ty;
+          S* __restrict px = xs.data();
+          S* __restrict py = ys.data();
+          for (size_t i = begin; i < end; i++) {
+            S x = px[i], y = py[i];
+            px[i] = a * x + b * y + tx;
+            py[i] = c * x + d * y + ty;
+          }
+        },
+        threads);
+  }
+};
+
+using Affine2D = BasicAffine2D<double>;
+} // namespace plane
@@ -0,0 +1,143 @@
+#pragma once
+#include "parallel.hpp"
+#include "plane.hpp"
+#include <array>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Rotating calipers over a convex polygon given CCW without collinear
+// vertices, as produced by convex_hull().
+namespace plane {
+struct PointPair {
+  Point a, b;
+  double distance;
+};
+
+struct Strip {
+  Segment edge;
+  Point opposite;
+  double width;
+};
+
+struct OrientedBox {
+  std::array<Point, 4> corners;
+  double area;
+};
+
+namespace detail {
+inline double area2(const Point& a, const Point& b, const Point& c) {
+  return (b - a).cross(c - a);
+}
+
+inline double distance(const Point& a, const Point& b) {
+  Vector d = b - a;
+  return std::sqrt(d * d);
+}
+} // namespace detail
+
+inline PointPair diameter(std::span<const Point> hull) {
+  size_t n = hull.size();
+  if (n == 0)
+    return {Point{0, 0}, Point{0, 0}, 0};
+  PointPair best{hull[0], hull[0], 0};
+  auto consider = [&](size_t i, size_t j) {
+    double d = detail::distance(hull[i], hull[j]);
+    if (d > best.distance)
+      best = {hull[i], hull[j], d};
+  };
+  if (n <= 2) {
+    consider(0, n - 1);
+    return best;
+  }
+  for (size_t i = 0, j = 1; i < n; i++) {
+    size_t i1 = (i + 1) % n;
+    while (detail::area2(hull[i], hull[i1], hull[(j + 1) % n]) >
+           detail::area2(hull[i], hull[i1], hull[j]))
+      j = (j + 1) % n;
+    consider(i, j);
+    consider(i1, j);
+  }
+  return best;
+}
+
+inline Strip width(std::span<const Point> hull) {
+  size_t n = hull.size();
+  if (n < 3) {
+    Point a = n > 0 ? hull[0] : Point{0, 0};
+    Point b = n > 1 ? hull[1] : a;
+    return {Segment{a, b}, a, 0};
+  }
+  Strip best{Segment{hull[0], hull[1]}, hull[0],
+             std::numeric_limits<double>::infinity()};
+  for (size_t i = 0, j = 1; i < n; i++) {
+    size_t i1 = (i + 1) % n;
+    while (detail::area2(hull[i], hull[i1], hull[(j + 1) % n]) >
+           detail::area2(hull[i], hull[i1], hull[j]))
+      j = (j + 1) % n;
+    double w = detail::area2(hull[i], hull[i1], hull[j]) /
+               detail::distance(hull[i], hull[i1]);
+    if (w < best.width)
+      best = {Segment{hull[i], hull[i1]}, hull[j], w};
+  }
+  return best;
+}
+
+inline OrientedBox min_area_rect(std::span<const Point> hull) {
+  size_t n = hull.size();
+  if (n < 3) {
+    Point a = n > 0 ? hull[0] : Point{0, 0};
+    Point b = n > 1 ? hull[1] : a;
+    return {{a, b, b, a}, 0};
+  }
+
+  OrientedBox best{{}, std::numeric_limits<double>::infinity()};
+  size_t right = 1, top = 1, left = 1;
+  for (size_t i = 0; i < n; i++) {
+    const Point& o = hull[i];
+    Vector e = hull[(i + 1) % n] - o;
+    double len = std::sqrt(e * e);
+    Vector u{e.x / len, e.y / len}, v{-u.y, u.x};
+    auto along = [&](size_t k) { return u * (hull[k] - o); };
+    auto up = [&](size_t k) { return v * (hull[k] - o); };
+
+    while (along((right + 1) % n) >= along(right))
+      right = (right + 1) % n;
+    if (i == 0)
+      top = right;
+    while (up((top + 1) % n) >= up(top))
+      top = (top + 1) % n;
+    if (i == 0)
+      left = top;
+    while (along((left + 1) % n) <= along(left))
+      left = (left + 1) % n;
+
+    double lo = along(left), hi = along(right), h = up(top);
+    double area = (hi - lo) * h;
+    if (area < best.area) {
+      auto at = [&](double s, double t) {
+        return Point{o.x + u.x * s + v.x * t, o.y + u.y * s + v.y * t};
+      };
+      best = {{at(lo, 0), at(hi, 0), at(hi, h), at(lo, h)}, area};
+    }
+  }
+  return best;
+}
+
+template <typename F>
+auto for_each_hull(std::span<const std::vector<Point>> hulls, F&& f,
+                   unsigned threads = 0) {
+  using R = std::invoke_result_t<F&, std::span<const Point>>;
+  std::vector<R> result(hulls.size());
+  lib::parallel_for(
+      hulls.size(),
+      [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+          result[i] = f(std::span<const Point>(hulls[i]));
+      },
+      threads);
+  return result;
+}
+} // namespace plane
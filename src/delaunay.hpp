@@ -0,0 +1,663 @@
+#pragma once
+#include "parallel.hpp"
+#include "plane.hpp"
+#include "predicates.hpp"
+#include "spatial_sort.hpp"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace plane {
+namespace detail {
+// Guibas-Stolfi divide and conquer over points sorted by (x, y). Edges
+// are kept without their duals: directed edge e and its twin e ^ 1 share
+// a slot, and each knows the next and previous edge counterclockwise
+// around its origin. A range of m sorted points owns 4m slots, enough
+// for its live edges throughout its merge, so the two halves of a range
+// are built concurrently without sharing an allocator.
+class DelaunayDc {
+public:
+  static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+  DelaunayDc(std::span<const Point> points, unsigned threads)
+      : points_(points),
+        threads_(threads == 0 ? lib::hardware_threads() : threads) {
+    sort_(threads_);
+    size_t m = sorted_.size();
+    if (m < 2)
+      return;
+    org_.resize(8 * m);
+    onext_.resize(8 * m);
+    oprev_.resize(8 * m);
+    build_(0, m, threads_);
+  }
+
+  // The faces as CCW vertex triples, with the twin of each half-edge.
+  // Each face is emitted by its lowest edge, so blocks of edges are
+  // counted and then written concurrently.
+  void triangles(std::vector<uint32_t>& triangles,
+                 std::vector<uint32_t>& halfedges) const {
+    size_t n = org_.size(), blocks = threads_;
+    auto block = [&](size_t b) {
+      return std::pair(static_cast<uint32_t>(n * b / blocks),
+                       static_cast<uint32_t>(n * (b + 1) / blocks));
+    };
+    auto lowest = [this](uint32_t e) {
+      if (org_[e & ~1u] == npos)
+        return false;
+      uint32_t e1 = lnext_(e), e2 = lnext_(e1);
+      return e < e1 && e < e2 && lnext_(e2) == e &&
+             orient2d(org_pt_(e), org_pt_(e1), org_pt_(e2)) > 0;
+    };
+    std::vector<size_t> first(blocks + 1, 0);
+    lib::parallel_for(
+        blocks,
+        [&](size_t begin, size_t end) {
+          for (size_t b = begin; b < end; b++) {
+            auto [lo, hi] = block(b);
+            for (uint32_t e = lo; e < hi; e++)
+              first[b + 1] += lowest(e);
+          }
+        },
+        threads_);
+    for (size_t b = 0; b < blocks; b++)
+      first[b + 1] += first[b];
+
+    std::vector<uint32_t> half_of(n), edge_of(3 * first[blocks]);
+    triangles.resize(edge_of.size());
+    halfedges.resize(edge_of.size());
+    lib::parallel_for(
+        blocks,
+        [&](size_t begin, size_t end) {
+          for (size_t b = begin; b < end; b++) {
+            auto [lo, hi] = block(b);
+            auto h = static_cast<uint32_t>(3 * first[b]);
+            for (uint32_t e = lo; e < hi; e++) {
+              if (!lowest(e))
+                continue;
+              for (uint32_t d = e, k = 0; k < 3; d = lnext_(d), k++, h++) {
+                half_of[d] = h;
+                edge_of[h] = d;
+                triangles[h] = sorted_[org_[d]];
+              }
+            }
+          }
+        },
+        threads_);
+    // A twin outside every face lies on the hull.
+    lib::parallel_for(
+        halfedges.size(),
+        [&](size_t begin, size_t end) {
+          for (size_t h = begin; h < end; h++) {
+            uint32_t twin = edge_of[h] ^ 1;
+            uint32_t t = half_of[twin];
+            halfedges[h] = t < edge_of.size() && edge_of[t] == twin ? t : npos;
+          }
+        },
+        threads_);
+  }
+
+private:
+  // Slots of a range not holding an edge, linked through onext_.
+  struct Pool {
+    uint32_t head = npos, tail = npos;
+  };
+  // The hull edge leaving the leftmost point counterclockwise and the
+  // one leaving the rightmost point clockwise.
+  struct Hull {
+    uint32_t left, right;
+    Pool pool;
+  };
+  static constexpr size_t parallel_cutoff = 1 << 14;
+
+  std::span<const Point> points_;
+  unsigned threads_;
+  // Edges refer to positions in sorted_, whose points are copied to pts_
+  // so the merges read them in order.
+  std::vector<uint32_t> sorted_;
+  std::vector<Point> pts_;
+  std::vector<uint32_t> org_, onext_, oprev_;
+
+  // Maps doubles to integers in the same order.
+  static uint64_t order_key_(double v) {
+    uint64_t bits = std::bit_cast<uint64_t>(v + 0.0);
+    return bits >> 63 ? ~bits : bits | uint64_t(1) << 63;
+  }
+
+  // Lexicographic order by two stable radix passes, dropping duplicates.
+  void sort_(unsigned threads) {
+    size_t n = points_.size();
+    std::vector<uint64_t> keys(n);
+    for (size_t i = 0; i < n; i++)
+      keys[i] = order_key_(points_[i].y);
+    auto by_y = radix_order(keys, threads);
+    for (size_t i = 0; i < n; i++)
+      keys[i] = order_key_(points_[by_y[i]].x);
+    auto by_x = radix_order(keys, threads);
+    sorted_.resize(n);
+    size_t m = 0;
+    for (size_t i = 0; i < n; i++) {
+      uint32_t v = by_y[by_x[i]];
+      const Point& p = points_[v];
+      if (m > 0 && points_[sorted_[m - 1]].x == p.x &&
+          points_[sorted_[m - 1]].y == p.y)
+        continue;
+      sorted_[m++] = v;
+    }
+    sorted_.resize(m);
+    pts_.resize(m);
+    for (size_t i = 0; i < m; i++)
+      pts_[i] = points_[sorted_[i]];
+  }
+
+  const Point& org_pt_(uint32_t e) const { return pts_[org_[e]]; }
+  const Point& dest_pt_(uint32_t e) const { return pts_[org_[e ^ 1]]; }
+  uint32_t lnext_(uint32_t e) const { return oprev_[e ^ 1]; }
+  uint32_t rprev_(uint32_t e) const { return onext_[e ^ 1]; }
+  bool left_of_(const Point& p, uint32_t e) const {
+    return orient2d(p, org_pt_(e), dest_pt_(e)) > 0;
+  }
+  bool right_of_(const Point& p, uint32_t e) const {
+    return orient2d(p, dest_pt_(e), org_pt_(e)) > 0;
+  }
+
+  // Joins the origin rings of a and b if they differ, or splits them.
+  void splice_(uint32_t a, uint32_t b) {
+    std::swap(onext_[a], onext_[b]);
+    oprev_[onext_[a]] = a;
+    oprev_[onext_[b]] = b;
+  }
+
+  void release_(Pool& pool, uint32_t slot) {
+    org_[2 * slot] = npos;
+    onext_[2 * slot] = pool.head;
+    if (pool.head == npos)
+      pool.tail = slot;
+    pool.head = slot;
+  }
+
+  Pool join_(Pool a, Pool b) {
+    if (a.head == npos)
+      return b;
+    if (b.head != npos) {
+      onext_[2 * a.tail] = b.head;
+      a.tail = b.tail;
+    }
+    return a;
+  }
+
+  uint32_t make_edge_(Pool& pool, uint32_t from, uint32_t to) {
+    assert(pool.head != npos);
+    uint32_t e = 2 * pool.head;
+    pool.head = onext_[e];
+    if (pool.head == npos)
+      pool.tail = npos;
+    org_[e] = from, org_[e + 1] = to;
+    onext_[e] = oprev_[e] = e;
+    onext_[e + 1] = oprev_[e + 1] = e + 1;
+    return e;
+  }
+
+  void delete_(Pool& pool, uint32_t e) {
+    splice_(e, oprev_[e]);
+    splice_(e ^ 1, oprev_[e ^ 1]);
+    release_(pool, e / 2);
+  }
+
+  // A new edge from the end of a to the start of b.
+  uint32_t connect_(Pool& pool, uint32_t a, uint32_t b) {
+    uint32_t e = make_edge_(pool, org_[a ^ 1], org_[b]);
+    splice_(e, lnext_(a));
+    splice_(e ^ 1, b);
+    return e;
+  }
+
+  Hull leaf_(size_t lo, size_t hi) {
+    Pool pool;
+    for (size_t slot = 4 * hi; slot-- > 4 * lo;)
+      release_(pool, static_cast<uint32_t>(slot));
+    auto s0 = static_cast<uint32_t>(lo);
+    uint32_t a = make_edge_(pool, s0, s0 + 1);
+    if (hi - lo == 2)
+      return {a, a ^ 1, pool};
+    uint32_t b = make_edge_(pool, s0 + 1, s0 + 2);
+    splice_(a ^ 1, b);
+    int o = orient2d(pts_[s0], pts_[s0 + 1], pts_[s0 + 2]);
+    if (o > 0) {
+      connect_(pool, b, a);
+    } else if (o < 0) {
+      uint32_t c = connect_(pool, b, a);
+      return {c ^ 1, c, pool};
+    }
+    return {a, b ^ 1, pool};
+  }
+
+  Hull build_(size_t lo, size_t hi, unsigned threads) {
+    if (hi - lo <= 3)
+      return leaf_(lo, hi);
+    size_t mid = lo + (hi - lo) / 2;
+    Hull halves[2];
+    if (threads > 1 && hi - lo >= parallel_cutoff) {
+      lib::parallel_for(
+          2,
+          [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; k++)
+              halves[k] = k == 0 ? build_(lo, mid, threads / 2)
+                                 : build_(mid, hi, threads - threads / 2);
+          },
+          2);
+    } else {
+      halves[0] = build_(lo, mid, 1);
+      halves[1] = build_(mid, hi, 1);
+    }
+    return merge_(halves[0], halves[1]);
+  }
+
+  Hull merge_(const Hull& l, const Hull& r) {
+    Pool pool = join_(l.pool, r.pool);
+    uint32_t ldo = l.left, ldi = l.right, rdi = r.left, rdo = r.right;
+    // Lower common tangent of the two hulls.
+    while (true) {
+      if (left_of_(org_pt_(rdi), ldi))
+        ldi = lnext_(ldi);
+      else if (right_of_(org_pt_(ldi), rdi))
+        rdi = rprev_(rdi);
+      else
+        break;
+    }
+    uint32_t base = connect_(pool, rdi ^ 1, ldi);
+    if (org_[ldi] == org_[ldo])
+      ldo = base ^ 1;
+    if (org_[rdi] == org_[rdo])
+      rdo = base;
+
+    // Zip upwards, deleting edges whose circles the new cross edges enter.
+    auto valid = [&](uint32_t e) { return right_of_(dest_pt_(e), base); };
+    while (true) {
+      uint32_t lcand = onext_[base ^ 1];
+      if (valid(lcand))
+        while (incircle(dest_pt_(base), org_pt_(base), dest_pt_(lcand),
+                        dest_pt_(onext_[lcand])) > 0) {
+          uint32_t next = onext_[lcand];
+          delete_(pool, lcand);
+          lcand = next;
+        }
+      uint32_t rcand = oprev_[base];
+      if (valid(rcand))
+        while (incircle(dest_pt_(base), org_pt_(base), dest_pt_(rcand),
+                        dest_pt_(oprev_[rcand])) > 0) {
+          uint32_t next = oprev_[rcand];
+          delete_(pool, rcand);
+          rcand = next;
+        }
+      bool lvalid = valid(lcand), rvalid = valid(rcand);
+      if (!lvalid && !rvalid)
+        break;
+      if (!lvalid || (rvalid && incircle(dest_pt_(lcand), org_pt_(lcand),
+                                         org_pt_(rcand), dest_pt_(rcand)) > 0))
+        base = connect_(pool, rcand, base ^ 1);
+      else
+        base = connect_(pool, base ^ 1, lcand ^ 1);
+    }
+    return {ldo, rdo, pool};
+  }
+};
+} // namespace detail
+
+// Triangles are stored as vertex triples in CCW order; half-edge e goes
+// from triangles()[e] to triangles()[next_halfedge(e)] and halfedges()[e]
+// is its twin in the adjacent triangle, or npos on the convex hull.
+// The point span must outlive the triangulation.
+class Delaunay {
+public:
+  static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+  struct VoronoiCell {
+    std::vector<Point> vertices;
+    bool bounded;
+  };
+
+private:
+  std::span<const Point> points_;
+  std::vector<uint32_t> triangles_;
+  std::vector<uint32_t> halfedges_;
+  std::vector<uint32_t> inedges_;
+
+  // Construction state; vertex index points_.size() is the ghost vertex
+  // shared by the triangles glued onto every hull edge.
+  uint32_t ghost_ = 0;
+  std::vector<uint32_t> verts_;
+  std::vector<uint32_t> twins_;
+  std::vector<uint32_t> marks_;
+  std::vector<uint32_t> free_;
+  std::vector<uint32_t> stack_;
+  std::vector<uint32_t> cavity_;
+  std::vector<uint32_t> created_;
+  std::vector<uint32_t> out_tri_;
+  struct BoundaryEdge {
+    uint32_t from, to, twin;
+  };
+  std::vector<BoundaryEdge> boundary_;
+  uint32_t stamp_ = 0;
+  uint32_t last_ = 0;
+  uint32_t walk_rng_ = 0;
+
+  bool is_ghost_(uint32_t t) const {
+    return verts_[3 * t] == ghost_ || verts_[3 * t + 1] == ghost_ ||
+           verts_[3 * t + 2] == ghost_;
+  }
+  bool is_alive_(uint32_t t) const { return verts_[3 * t] != npos; }
+
+  bool conflict_(uint32_t t, const Point& p) const {
+    const uint32_t* v = &verts_[3 * t];
+    for (int j = 0; j < 3; j++) {
+      if (v[j] != ghost_)
+        continue;
+      const Point& a = points_[v[(j + 1) % 3]];
+      const Point& b = points_[v[(j + 2) % 3]];
+      int o = orient2d(a, b, p);
+      if (o != 0)
+        return o > 0;
+      return (p - a) * (b - a) > 0 && (p - b) * (a - b) > 0;
+    }
+    return incircle(points_[v[0]], points_[v[1]], points_[v[2]], p) > 0;
+  }
+
+  uint32_t alloc_() {
+    if (!free_.empty()) {
+      uint32_t t = free_.back();
+      free_.pop_back();
+      return t;
+    }
+    uint32_t t = static_cast<uint32_t>(verts_.size() / 3);
+    verts_.resize(verts_.size() + 3);
+    twins_.resize(twins_.size() + 3);
+    marks_.push_back(0);
+    return t;
+  }
+
+  uint32_t make_(uint32_t a, uint32_t b, uint32_t c) {
+    uint32_t t = alloc_();
+    verts_[3 * t] = a, verts_[3 * t + 1] = b, verts_[3 * t + 2] = c;
+    return t;
+  }
+
+  void link_(uint32_t e1, uint32_t e2) {
+    twins_[e1] = e2;
+    twins_[e2] = e1;
+  }
+
+  uint32_t locate_(const Point& p) {
+    uint32_t t = last_;
+    if (!is_alive_(t))
+      return npos;
+    size_t limit = verts_.size();
+    for (size_t step = 0; step < limit; step++) {
+      if (is_ghost_(t))
+        return t;
+      uint32_t r = walk_rng_++ % 3;
+      bool moved = false;
+      for (uint32_t k = 0; k < 3 && !moved; k++) {
+        uint32_t e = 3 * t + (r + k) % 3;
+        if (orient2d(points_[verts_[e]], points_[verts_[next_halfedge(e)]],
+                     p) < 0) {
+          t = twins_[e] / 3;
+          moved = true;
+        }
+      }
+      if (!moved)
+        return t;
+    }
+    return npos;
+  }
+
+  void insert_(uint32_t i) {
+    const Point& p = points_[i];
+    uint32_t start = locate_(p);
+    if (start != npos && !is_ghost_(start))
+      for (int j = 0; j < 3; j++) {
+        const Point& v = points_[verts_[3 * start + j]];
+        if (v.x == p.x && v.y == p.y)
+          return;
+      }
+    if (start == npos || !conflict_(start, p)) {
+      start = npos;
+      for (uint32_t t = 0; t < marks_.size() && start == npos; t++)
+        if (is_alive_(t) && conflict_(t, p))
+          start = t;
+      if (start == npos)
+        return;
+    }
+
+    stamp_++;
+    cavity_.clear();
+    stack_.assign(1, start);
+    marks_[start] = stamp_;
+    while (!stack_.empty()) {
+      uint32_t t = stack_.back();
+      stack_.pop_back();
+      cavity_.push_back(t);
+      for (uint32_t e = 3 * t; e < 3 * t + 3; e++) {
+        uint32_t n = twins_[e] / 3;
+        if (marks_[n] == stamp_)
+          continue;
+        uint32_t a = verts_[e], b = verts_[next_halfedge(e)];
+        bool flat = a != ghost_ && b != ghost_ && !is_ghost_(n) &&
+                    orient2d(points_[a], points_[b], p) <= 0;
+        if (flat || conflict_(n, p)) {
+          marks_[n] = stamp_;
+          stack_.push_back(n);
+        }
+      }
+    }
+
+    boundary_.clear();
+    for (uint32_t t : cavity_)
+      for (uint32_t e = 3 * t; e < 3 * t + 3; e++)
+        if (marks_[twins_[e] / 3] != stamp_)
+          boundary_.push_back({verts_[e], verts_[next_halfedge(e)], twins_[e]});
+    for (uint32_t t : cavity_) {
+      verts_[3 * t] = npos;
+      free_.push_back(t);
+    }
+
+    created_.clear();
+    for (auto& [a, b, twin] : boundary_) {
+      uint32_t t = make_(a, b, i);
+      link_(3 * t, twin);
+      out_tri_[a] = t;
+      created_.push_back(t);
+    }
+    for (uint32_t t : created_) {
+      link_(3 * t + 1, 3 * out_tri_[verts_[3 * t + 1]] + 2);
+      if (!is_ghost_(t))
+        last_ = t;
+    }
+  }
+
+  std::vector<uint32_t> brio_order_() const {
+    size_t n = points_.size();
+    std::vector<uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0u);
+    std::shuffle(order.begin(), order.end(), std::mt19937(0x5eed));
+    if (n == 0)
+      return order;
+
+    auto keys = curve_keys(points_, Curve::Hilbert, 1);
+
+    // Rounds grow geometrically: [0, n/2^k), ..., [n/4, n/2), [n/2, n).
+    std::vector<size_t> bounds{n};
+    while (bounds.back() > 64)
+      bounds.push_back(bounds.back() / 2);
+    bounds.push_back(0);
+    std::reverse(bounds.begin(), bounds.end());
+    for (size_t r = 0; r + 1 < bounds.size(); r++)
+      std::sort(order.begin() + bounds[r], order.begin() + bounds[r + 1],
+                [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+    return order;
+  }
+
+  void build_() {
+    size_t n = points_.size();
+    ghost_ = static_cast<uint32_t>(n);
+    auto order = brio_order_();
+
+    size_t i1 = 1, i2;
+    while (i1 < n && points_[order[i1]] == points_[order[0]])
+      i1++;
+    for (i2 = i1 + 1; i2 < n; i2++)
+      if (orient2d(points_[order[0]], points_[order[i1]], points_[order[i2]]) !=
+          0)
+        break;
+    if (i2 >= n)
+      return;
+
+    uint32_t a = order[0], b = order[i1], c = order[i2];
+    if (orient2d(points_[a], points_[b], points_[c]) < 0)
+      std::swap(b, c);
+    verts_.reserve(6 * n + 12);
+    twins_.reserve(6 * n + 12);
+    uint32_t t = make_(a, b, c);
+    uint32_t gab = make_(b, a, ghost_), gbc = make_(c, b, ghost_),
+             gca = make_(a, c, ghost_);
+    link_(3 * t, 3 * gab), link_(3 * t + 1, 3 * gbc), link_(3 * t + 2, 3 * gca);
+    link_(3 * gab + 2, 3 * gbc + 1), link_(3 * gbc + 2, 3 * gca + 1),
+        link_(3 * gca + 2, 3 * gab + 1);
+    last_ = t;
+
+    out_tri_.resize(n + 1);
+    for (size_t k = 1; k < n; k++)
+      if (k != i1 && k != i2)
+        insert_(order[k]);
+  }
+
+  void compact_() {
+    std::vector<uint32_t> remap(marks_.size(), npos);
+    uint32_t count = 0;
+    for (uint32_t t = 0; t < marks_.size(); t++)
+      if (is_alive_(t) && !is_ghost_(t))
+        remap[t] = count++;
+
+    triangles_.resize(3 * size_t(count));
+    halfedges_.resize(3 * size_t(count));
+    for (uint32_t t = 0; t < marks_.size(); t++) {
+      if (remap[t] == npos)
+        continue;
+      for (uint32_t j = 0; j < 3; j++) {
+        uint32_t twin = twins_[3 * t + j];
+        uint32_t target = remap[twin / 3];
+        triangles_[3 * remap[t] + j] = verts_[3 * t + j];
+        halfedges_[3 * remap[t] + j] =
+            target == npos ? npos : 3 * target + twin % 3;
+      }
+    }
+
+    std::vector<uint32_t>().swap(verts_);
+    std::vector<uint32_t>().swap(twins_);
+    std::vector<uint32_t>().swap(marks_);
+    std::vector<uint32_t>().swap(free_);
+    std::vector<uint32_t>().swap(out_tri_);
+  }
+
+  void build_inedges_() {
+    inedges_.assign(points_.size(), npos);
+    for (uint32_t e = 0; e < triangles_.size(); e++) {
+      uint32_t v = triangles_[next_halfedge(e)];
+      if (inedges_[v] == npos || halfedges_[e] == npos)
+        inedges_[v] = e;
+    }
+  }
+
+public:
+  // With one thread the points are inserted incrementally; with more,
+  // 0 meaning all hardware threads, they are triangulated by divide and
+  // conquer with the halves of large ranges built concurrently.
+  explicit Delaunay(std::span<const Point> points, unsigned threads = 1)
+      : points_(points) {
+    if (threads == 0)
+      threads = lib::hardware_threads();
+    if (threads == 1) {
+      build_();
+      compact_();
+    } else {
+      detail::DelaunayDc(points, threads).triangles(triangles_, halfedges_);
+    }
+    build_inedges_();
+  }
+
+  static uint32_t next_halfedge(uint32_t e) {
+    return e % 3 == 2 ? e - 2 : e + 1;
+  }
+  static uint32_t prev_halfedge(uint32_t e) {
+    return e % 3 == 0 ? e + 2 : e - 1;
+  }
+
+  std::span<const Point> points() const { return points_; }
+  const std::vector<uint32_t>& triangles() const { return triangles_; }
+  const std::vector<uint32_t>& halfedges() const { return halfedges_; }
+  size_t triangle_count() const { return triangles_.size() / 3; }
+
+  Point circumcenter(size_t t) const {
+    const Point& a = points_[triangles_[3 * t]];
+    const Point& b = points_[triangles_[3 * t + 1]];
+    const Point& c = points_[triangles_[3 * t + 2]];
+    double bx = b.x - a.x, by = b.y - a.y, cx = c.x - a.x, cy = c.y - a.y;
+    double bl = bx * bx + by * by, cl = cx * cx + cy * cy;
+    double d = 0.5 / (bx * cy - by * cx);
+    return {a.x + (cy * bl - by * cl) * d, a.y + (bx * cl - cx * bl) * d};
+  }
+
+  std::vector<Point> circumcenters(unsigned threads = 1) const {
+    std::vector<Point> result(triangle_count());
+    lib::parallel_for(
+        result.size(),
+        [&](size_t begin, size_t end) {
+          for (size_t t = begin; t < end; t++)
+            result[t] = circumcenter(t);
+        },
+        threads);
+    return result;
+  }
+
+  // Vertices of the Voronoi cell of a site in CCW order. Cells of hull
+  // sites are unbounded; their chain then runs between the circumcenters
+  // of the two hull triangles around the site.
+  VoronoiCell voronoi_cell(uint32_t site) const {
+    VoronoiCell cell{{}, true};
+    uint32_t start = inedges_[site];
+    if (start == npos)
+      return {{}, false};
+    uint32_t e = start;
+    do {
+      cell.vertices.push_back(circumcenter(e / 3));
+      e = halfedges_[next_halfedge(e)];
+      if (e == npos) {
+        cell.bounded = false;
+        break;
+      }
+    } while (e != start);
+    std::reverse(cell.vertices.begin(), cell.vertices.end());
+    return cell;
+  }
+
+  std::vector<VoronoiCell> voronoi(unsigned threads = 1) const {
+    std::vector<VoronoiCell> cells(points_.size());
+    lib::parallel_for(
+        cells.size(),
+        [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; i++)
+            cells[i] = voronoi_cell(static_cast<uint32_t>(i));
+        },
+        threads);
+    return cells;
+  }
+};
+} // namespace plane
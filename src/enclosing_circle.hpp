@@ -0,0 +1,89 @@
+#pragma once
+#include "parallel.hpp"
+#include "plane.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace plane {
+struct Circle {
+  Point center;
+  double radius;
+
+  // Relative slack so points defining the circle test as inside.
+  bool contains(const Point& p) const {
+    Vector d = p - center;
+    double r = radius * (1 + 1e-12) + 1e-300;
+    return d * d <= r * r;
+  }
+};
+
+namespace detail {
+inline Circle circle_of(const Point& a, const Point& b) {
+  Point c{(a.x + b.x) / 2, (a.y + b.y) / 2};
+  Vector d = a - c;
+  return {c, std::sqrt(d * d)};
+}
+
+// Falls back to the widest pair when the points are collinear.
+inline Circle circle_of(const Point& a, const Point& b, const Point& c) {
+  Vector ab = b - a, ac = c - a;
+  double det = 2 * ab.cross(ac);
+  if (det == 0) {
+    Circle best = circle_of(a, b);
+    for (Circle other : {circle_of(a, c), circle_of(b, c)})
+      if (other.radius > best.radius)
+        best = other;
+    return best;
+  }
+  double b2 = ab * ab, c2 = ac * ac;
+  Vector o{(ac.y * b2 - ab.y * c2) / det, (ab.x * c2 - ac.x * b2) / det};
+  return {Point{a.x + o.x, a.y + o.y}, std::sqrt(o * o)};
+}
+} // namespace detail
+
+// Welzl's algorithm unrolled into three loops, expected O(n) after the
+// shuffle. The points are reordered in place and nothing is allocated:
+// each point that forces a new circle is swapped to the front, so later
+// passes meet the support points early.
+inline Circle min_enclosing_circle(std::span<Point> points,
+                                   uint64_t seed = 0x5eed) {
+  if (points.empty())
+    return {Point{0, 0}, 0};
+  std::shuffle(points.begin(), points.end(), std::minstd_rand(seed | 1));
+  Circle c{points[0], 0};
+  for (size_t i = 1; i < points.size(); i++) {
+    if (c.contains(points[i]))
+      continue;
+    c = {points[i], 0};
+    for (size_t j = 0; j < i; j++) {
+      if (c.contains(points[j]))
+        continue;
+      c = detail::circle_of(points[i], points[j]);
+      for (size_t k = 0; k < j; k++)
+        if (!c.contains(points[k]))
+          c = detail::circle_of(points[i], points[j], points[k]);
+    }
+    std::swap(points[0], points[i]);
+  }
+  return c;
+}
+
+// Independent clusters are spread over threads; each is shuffled in place.
+inline std::vector<Circle>
+min_enclosing_circles(std::span<std::vector<Point>> clusters,
+                      unsigned threads = 0, uint64_t seed = 0x5eed) {
+  std::vector<Circle> result(clusters.size());
+  lib::parallel_for(
+      clusters.size(),
+      [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+          result[i] = min_enclosing_circle(clusters[i], seed + i);
+      },
+      threads);
+  return result;
+}
+} // namespace plane
@@ -0,0 +1,171 @@
+#pragma once
+#include "plane.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <deque>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace plane {
+enum class Side { Left, Right };
+
+// The feasible side is to the left of line.direction.
+struct HalfPlane {
+  Line line;
+
+  HalfPlane(const Line& line, Side side = Side::Left)
+      : line(side == Side::Left
+                 ? line
+                 : Line(line.start, Vector::zero() - line.direction)) {}
+
+  double side_of(const Point& p) const {
+    const Vector& d = line.direction;
+    Vector v = p - line.start;
+    return d.x * v.y - d.y * v.x;
+  }
+  bool contains(const Point& p) const { return side_of(p) > -1e-9; }
+  double angle() const { return std::atan2(line.direction.y, line.direction.x); }
+};
+
+inline std::array<HalfPlane, 4> box_halfplanes(const Point& lo,
+                                               const Point& hi) {
+  return {HalfPlane(Line(lo, Vector{1, 0})), HalfPlane(Line(hi, Vector{0, 1})),
+          HalfPlane(Line(hi, Vector{-1, 0})),
+          HalfPlane(Line(lo, Vector{0, -1}))};
+}
+
+namespace detail {
+inline Point boundary_intersection(const HalfPlane& a, const HalfPlane& b) {
+  auto p = a.line.intersection(b.line);
+  return p ? *p : a.line.start;
+}
+} // namespace detail
+
+// Vertices of the intersection in CCW order, empty if it is empty or
+// degenerate. The intersection must be bounded; add box_halfplanes()
+// when that is not guaranteed.
+inline std::vector<Point> intersect_halfplanes(std::span<const HalfPlane> planes) {
+  std::vector<HalfPlane> hs(planes.begin(), planes.end());
+  std::vector<double> angles(hs.size());
+  std::vector<size_t> order(hs.size());
+  for (size_t i = 0; i < hs.size(); i++)
+    angles[i] = hs[i].angle(), order[i] = i;
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    if (angles[a] != angles[b])
+      return angles[a] < angles[b];
+    return hs[a].side_of(hs[b].line.start) < 0;
+  });
+
+  std::deque<HalfPlane> dq;
+  for (size_t k = 0; k < order.size(); k++) {
+    const HalfPlane& h = hs[order[k]];
+    if (k > 0 && angles[order[k]] == angles[order[k - 1]])
+      continue;
+    while (dq.size() > 1 &&
+           !h.contains(detail::boundary_intersection(dq.back(), dq[dq.size() - 2])))
+      dq.pop_back();
+    while (dq.size() > 1 &&
+           !h.contains(detail::boundary_intersection(dq[0], dq[1])))
+      dq.pop_front();
+    if (!dq.empty() && dq.back().line.direction.isCollinear(h.line.direction)) {
+      if (dq.back().line.direction * h.line.direction < 0)
+        return {};
+      if (h.contains(dq.back().line.start))
+        continue;
+      dq.pop_back();
+    }
+    dq.push_back(h);
+  }
+  while (dq.size() > 2 &&
+         !dq[0].contains(detail::boundary_intersection(dq.back(), dq[dq.size() - 2])))
+    dq.pop_back();
+  while (dq.size() > 2 &&
+         !dq.back().contains(detail::boundary_intersection(dq[0], dq[1])))
+    dq.pop_front();
+  if (dq.size() < 3)
+    return {};
+
+  std::vector<Point> polygon;
+  polygon.reserve(dq.size());
+  for (size_t i = 0; i < dq.size(); i++) {
+    Point p = detail::boundary_intersection(dq[i], dq[(i + 1) % dq.size()]);
+    if (polygon.empty() || !(polygon.back() == p))
+      polygon.push_back(p);
+  }
+  if (polygon.size() > 1 && polygon.front() == polygon.back())
+    polygon.pop_back();
+  if (polygon.size() < 3)
+    return {};
+  return polygon;
+}
+
+enum class LpStatus { Optimal, Infeasible, Unbounded };
+
+struct LpResult {
+  LpStatus status;
+  Point point;
+};
+
+// Seidel's randomized incremental LP: maximizes objective * x over the
+// intersection, in expected O(n). Variables are confined to
+// [-bound, bound]^2; an optimum whose value depends on that box is
+// reported as Unbounded. Among equal optima the point chosen on each
+// constraint is the one nearest its line's start.
+inline LpResult solve_lp(std::span<const HalfPlane> planes,
+                         const Vector& objective, double bound = 1e9,
+                         unsigned seed = 0x5eed) {
+  std::vector<HalfPlane> hs;
+  hs.reserve(planes.size() + 4);
+  for (auto& h : box_halfplanes(Point{-bound, -bound}, Point{bound, bound}))
+    hs.push_back(h);
+  hs.insert(hs.end(), planes.begin(), planes.end());
+  std::shuffle(hs.begin() + 4, hs.end(), std::mt19937(seed));
+
+  auto extreme = [bound](double c) {
+    return c > 0 ? bound : c < 0 ? -bound : 0.0;
+  };
+  Point v{extreme(objective.x), extreme(objective.y)};
+  // Whether the objective at v is set by the box rather than the planes.
+  bool boxed = objective.x != 0 || objective.y != 0;
+  for (size_t i = 4; i < hs.size(); i++) {
+    if (hs[i].contains(v))
+      continue;
+
+    const Line& l = hs[i].line;
+    double lo = -INFINITY, hi = INFINITY;
+    size_t lo_by = 0, hi_by = 0;
+    for (size_t j = 0; j < i; j++) {
+      const Vector& d = hs[j].line.direction;
+      double num = hs[j].side_of(l.start);
+      double den = d.x * l.direction.y - d.y * l.direction.x;
+      if (partial_eq(den, 0.0)) {
+        if (num < -1e-9)
+          return {LpStatus::Infeasible, v};
+        continue;
+      }
+      double t = -num / den;
+      if (den > 0 && t > lo)
+        lo = t, lo_by = j;
+      else if (den < 0 && t < hi)
+        hi = t, hi_by = j;
+    }
+    if (lo > hi + 1e-9)
+      return {LpStatus::Infeasible, v};
+
+    double gain = objective * l.direction;
+    double t;
+    if (partial_eq(gain, 0.0)) {
+      // The objective is constant along l.
+      t = std::clamp(0.0, lo, std::max(lo, hi));
+      boxed = false;
+    } else {
+      t = gain > 0 ? hi : lo;
+      boxed = (gain > 0 ? hi_by : lo_by) < 4;
+    }
+    v = Point{l.start.x + l.direction.x * t, l.start.y + l.direction.y * t};
+  }
+  return {boxed ? LpStatus::Unbounded : LpStatus::Optimal, v};
+}
+} // namespace plane
@@ -0,0 +1,41 @@
+#pragma once
+#include "plane.hpp"
+#include <algorithm>
+#include <span>
+#include <vector>
+
+namespace plane {
+// Andrew's monotone chain. The hull is CCW, starts at the lowest
+// (x, y) point and has no collinear vertices.
+inline std::vector<Point> convex_hull(std::span<const Point> points) {
+  std::vector<Point> sorted(points.begin(), points.end());
+  std::sort(sorted.begin(), sorted.end(), [](const Point& a, const Point& b) {
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+  });
+  sorted.erase(std::unique(sorted.begin(), sorted.end(),
+                           [](const Point& a, const Point& b) {
+                             return a.x == b.x && a.y == b.y;
+                           }),
+               sorted.end());
+  if (sorted.size() < 3)
+    return sorted;
+
+  std::vector<Point> hull(2 * sorted.size());
+  size_t k = 0;
+  auto turn = [&hull, &k](const Point& p) {
+    return (hull[k - 1] - hull[k - 2]).cross(p - hull[k - 2]);
+  };
+  for (const Point& p : sorted) {
+    while (k >= 2 && turn(p) <= 0)
+      k--;
+    hull[k++] = p;
+  }
+  for (size_t i = sorted.size() - 1, lower = k + 1; i-- > 0;) {
+    while (k >= lower && turn(sorted[i]) <= 0)
+      k--;
+    hull[k++] = sorted[i];
+  }
+  hull.resize(k - 1);
+  return hull;
+}
+} // namespace plane
@@ -0,0 +1,450 @@
+#pragma once
+#include "../parallel.hpp"
+#include "io.hpp"
+#include <atomic>
+#include <cerrno>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Coroutine counterparts of Reader and Writer for non-blocking pipes and
+// sockets. A Reactor owns an epoll set and resumes each stream's waiting
+// coroutine on its own thread, so one thread can serve any number of
+// streams; ReactorPool runs one reactor per core.
+namespace io {
+template <typename T = void>
+class Task;
+
+namespace detail {
+struct PromiseBase {
+  std::coroutine_handle<> continuation;
+  std::exception_ptr exception;
+  // Set for tasks handed to Reactor::spawn, which own their frame.
+  std::atomic<size_t>* detached = nullptr;
+
+  struct FinalAwaiter {
+    bool await_ready() noexcept { return false; }
+    template <typename P>
+    std::coroutine_handle<>
+    await_suspend(std::coroutine_handle<P> h) noexcept {
+      PromiseBase& p = h.promise();
+      if (p.continuation)
+        return p.continuation;
+      if (p.detached) {
+        if (p.exception)
+          std::terminate();
+        auto* pending = p.detached;
+        h.destroy();
+        pending->fetch_sub(1, std::memory_order_release);
+      }
+      return std::noop_coroutine();
+    }
+    void await_resume() noexcept {}
+  };
+
+  std::suspend_always initial_suspend() noexcept { return {}; }
+  FinalAwaiter final_suspend() noexcept { return {}; }
+  void unhandled_exception() { exception = std::current_exception(); }
+};
+
+template <typename T>
+struct Promise : PromiseBase {
+  std::variant<std::monostate, T> value;
+  Task<T> get_return_object();
+  template <typename U>
+  void return_value(U&& v) {
+    value.template emplace<1>(std::forward<U>(v));
+  }
+  T result() {
+    if (exception)
+      std::rethrow_exception(exception);
+    return std::move(std::get<1>(value));
+  }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+  Task<void> get_return_object();
+  void return_void() {}
+  void result() {
+    if (exception)
+      std::rethrow_exception(exception);
+  }
+};
+} // namespace detail
+
+// A lazily started coroutine. Awaiting it runs it to completion and
+// resumes the awaiter directly, without a trip through the reactor.
+template <typename T>
+class [[nodiscard]] Task {
+public:
+  using promise_type = detail::Promise<T>;
+
+private:
+  std::coroutine_handle<promise_type> h_;
+  friend class Reactor;
+
+public:
+  explicit Task(std::coroutine_handle<promise_type> h) : h_(h) {}
+  Task(Task&& other) : h_(std::exchange(other.h_, {})) {}
+  Task& operator=(Task other) {
+    std::swap(h_, other.h_);
+    return *this;
+  }
+  ~Task() {
+    if (h_)
+      h_.destroy();
+  }
+
+  bool await_ready() const { return false; }
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) {
+    h_.promise().continuation = awaiter;
+    return h_;
+  }
+  T await_resume() { return h_.promise().result(); }
+};
+
+template <typename T>
+Task<T> detail::Promise<T>::get_return_object() {
+  return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> detail::Promise<void>::get_return_object() {
+  return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+// The coroutines blocked on one file descriptor. A stream is driven from
+// its reactor's thread, so at most one reader and one writer wait.
+struct IoWaiter {
+  std::coroutine_handle<> reader;
+  std::coroutine_handle<> writer;
+};
+
+class Reactor {
+  int epfd_ = -1;
+  int wakefd_ = -1;
+  std::atomic<size_t> pending_{0};
+  std::atomic<bool> stopped_{false};
+  std::mutex mutex_;
+  std::vector<std::coroutine_handle<>> posted_, ready_;
+
+  void wake_() {
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t n = ::write(wakefd_, &one, sizeof(one));
+  }
+
+  void resume_ready_() {
+    for (auto h : ready_)
+      h.resume();
+    ready_.clear();
+  }
+
+  void resume_posted_() {
+    {
+      std::lock_guard lock(mutex_);
+      ready_.swap(posted_);
+    }
+    resume_ready_();
+  }
+
+  void poll_(int timeout_ms) {
+    epoll_event events[64];
+    int n = ::epoll_wait(epfd_, events, 64, timeout_ms);
+    for (int i = 0; i < n; i++) {
+      auto* w = static_cast<IoWaiter*>(events[i].data.ptr);
+      if (!w) {
+        uint64_t count;
+        [[maybe_unused]] ssize_t r = ::read(wakefd_, &count, sizeof(count));
+        continue;
+      }
+      uint32_t ev = events[i].events;
+      // Errors and hangups wake both sides; the retried call reports them.
+      if ((ev & (EPOLLIN | EPOLLERR | EPOLLHUP | EPOLLRDHUP)) && w->reader)
+        ready_.push_back(std::exchange(w->reader, {}));
+      if ((ev & (EPOLLOUT | EPOLLERR | EPOLLHUP)) && w->writer)
+        ready_.push_back(std::exchange(w->writer, {}));
+    }
+    // Resumed only after the batch is read: a coroutine may close a
+    // stream whose waiter a later event still points to.
+    resume_ready_();
+  }
+
+  void run_(bool until_stopped) {
+    while (!stopped_.load(std::memory_order_acquire)) {
+      resume_posted_();
+      if (!until_stopped && pending_.load(std::memory_order_acquire) == 0)
+        break;
+      poll_(-1);
+    }
+  }
+
+public:
+  Reactor() {
+    epfd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wakefd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    ::epoll_ctl(epfd_, EPOLL_CTL_ADD, wakefd_, &ev);
+  }
+  Reactor(const Reactor&) = delete;
+  Reactor& operator=(const Reactor&) = delete;
+  ~Reactor() {
+    ::close(wakefd_);
+    ::close(epfd_);
+  }
+
+  // Edge-triggered, so each readiness change is reported once and a
+  // stream waits only after a call has returned EAGAIN.
+  Expected<void> add(int fd, IoWaiter* waiter) {
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = waiter;
+    if (::epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) != 0)
+      return Unexpected(Err::InvalidData);
+    return {};
+  }
+  void remove(int fd) { ::epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, nullptr); }
+
+  // Resumes h on the reactor's thread; callable from any thread.
+  void post(std::coroutine_handle<> h) {
+    {
+      std::lock_guard lock(mutex_);
+      posted_.push_back(h);
+    }
+    wake_();
+  }
+
+  // Starts a task on this reactor. It owns itself from here on and must
+  // not let exceptions escape.
+  void spawn(Task<void> task) {
+    auto h = std::exchange(task.h_, {});
+    h.promise().detached = &pending_;
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    post(h);
+  }
+
+  // Runs until every spawned task has finished or stop() is called.
+  void run() { run_(false); }
+  // Keeps serving new work until stop() is called.
+  void run_until_stopped() { run_(true); }
+  void stop() {
+    stopped_.store(true, std::memory_order_release);
+    wake_();
+  }
+
+  // Suspends until the next turn of the event loop, letting other ready
+  // coroutines run.
+  auto yield() {
+    struct Awaiter {
+      Reactor& r;
+      bool await_ready() { return false; }
+      void await_suspend(std::coroutine_handle<> h) { r.post(h); }
+      void await_resume() {}
+    };
+    return Awaiter{*this};
+  }
+};
+
+// One reactor per thread, each thread pinned to its own core. Streams are
+// bound to a reactor when created and spawned tasks must stay on it.
+class ReactorPool {
+  std::vector<std::unique_ptr<Reactor>> reactors_;
+  std::vector<std::jthread> threads_;
+  std::atomic<size_t> next_{0};
+
+public:
+  explicit ReactorPool(unsigned threads = 0) {
+    if (threads == 0)
+      threads = lib::hardware_threads();
+    for (unsigned i = 0; i < threads; i++)
+      reactors_.push_back(std::make_unique<Reactor>());
+    for (unsigned i = 0; i < threads; i++) {
+      threads_.emplace_back(
+          [r = reactors_[i].get()] { r->run_until_stopped(); });
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(i % CPU_SETSIZE, &cpus);
+      // Best effort: containers may restrict the usable cores.
+      ::pthread_setaffinity_np(threads_.back().native_handle(), sizeof(cpus),
+                               &cpus);
+    }
+  }
+  ~ReactorPool() { stop(); }
+
+  size_t size() const { return reactors_.size(); }
+  Reactor& operator[](size_t i) { return *reactors_[i]; }
+  // Round-robin choice for placing a new stream.
+  Reactor& next() {
+    return *reactors_[next_.fetch_add(1, std::memory_order_relaxed) %
+                      reactors_.size()];
+  }
+
+  // Stops every reactor and joins its thread; tasks still suspended are
+  // abandoned.
+  void stop() {
+    for (auto& r : reactors_)
+      r->stop();
+    threads_.clear();
+  }
+};
+
+class AsyncReader {
+public:
+  virtual Task<Expected<size_t>> read(std::span<std::byte> buf) = 0;
+  virtual ~AsyncReader() = default;
+
+  Task<Expected<void>> read_exact(std::span<std::byte> buf) {
+    while (!buf.empty()) {
+      auto res = co_await read(buf);
+      if (!res)
+        co_return Unexpected(res.error());
+      if (*res == 0)
+        co_return Unexpected(Err::UnexpectedEof);
+      buf = buf.subspan(*res);
+    }
+    co_return Expected<void>{};
+  }
+};
+
+class AsyncWriter {
+public:
+  virtual Task<Expected<size_t>> write(std::span<const std::byte> buf) = 0;
+  virtual Task<Expected<void>> flush() = 0;
+  virtual ~AsyncWriter() = default;
+
+  Task<Expected<void>> write_all(std::span<const std::byte> buf) {
+    while (!buf.empty()) {
+      auto res = co_await write(buf);
+      if (!res)
+        co_return Unexpected(res.error());
+      if (*res == 0)
+        co_return Unexpected(Err::WriteZero);
+      buf = buf.subspan(*res);
+    }
+    co_return Expected<void>{};
+  }
+};
+
+// A non-blocking pipe or socket registered with a reactor. Calls first
+// try the syscall and only suspend when it would block.
+class AsyncFd : public AsyncReader, public AsyncWriter {
+  Reactor* reactor_;
+  int fd_ = -1;
+  bool owned_ = false;
+  // Heap-allocated so epoll's pointer to it survives moves.
+  std::unique_ptr<IoWaiter> waiter_;
+
+  auto ready_(bool write) {
+    struct Awaiter {
+      IoWaiter& w;
+      bool write;
+      bool await_ready() { return false; }
+      void await_suspend(std::coroutine_handle<> h) {
+        (write ? w.writer : w.reader) = h;
+      }
+      void await_resume() {}
+    };
+    return Awaiter{*waiter_, write};
+  }
+
+  template <typename F>
+  Task<Expected<size_t>> retry_(bool write, F f) {
+    while (true) {
+      ssize_t n = f();
+      if (n >= 0)
+        co_return static_cast<size_t>(n);
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        co_await ready_(write);
+      else if (errno != EINTR)
+        co_return Unexpected(Err::InvalidData);
+    }
+  }
+
+  AsyncFd(Reactor& reactor, int fd, bool owned)
+      : reactor_(&reactor), fd_(fd), owned_(owned),
+        waiter_(std::make_unique<IoWaiter>()) {}
+
+public:
+  // Switches fd to non-blocking mode and registers it with reactor.
+  static Expected<AsyncFd> attach(Reactor& reactor, int fd,
+                                  bool owned = false) {
+    AsyncFd f(reactor, fd, owned);
+    int flags = ::fcntl(fd, F_GETFL);
+    if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+      return Unexpected(Err::InvalidData);
+    auto res = reactor.add(fd, f.waiter_.get());
+    if (!res)
+      return Unexpected(res.error());
+    return f;
+  }
+
+  // Both ends of a new pipe: read end first.
+  static Expected<std::pair<AsyncFd, AsyncFd>> pipe(Reactor& reader,
+                                                    Reactor& writer) {
+    int fds[2];
+    if (::pipe2(fds, O_CLOEXEC) != 0)
+      return Unexpected(Err::InvalidData);
+    auto r = attach(reader, fds[0], true);
+    if (!r) {
+      ::close(fds[1]);
+      return Unexpected(r.error());
+    }
+    auto w = attach(writer, fds[1], true);
+    if (!w)
+      return Unexpected(w.error());
+    return std::pair(std::move(*r), std::move(*w));
+  }
+
+  AsyncFd(AsyncFd&& other)
+      : reactor_(other.reactor_), fd_(std::exchange(other.fd_, -1)),
+        owned_(std::exchange(other.owned_, false)),
+        waiter_(std::move(other.waiter_)) {}
+  ~AsyncFd() {
+    if (fd_ >= 0)
+      reactor_->remove(fd_);
+    if (owned_)
+      ::close(fd_);
+  }
+
+  int fd() const { return fd_; }
+  Reactor& reactor() const { return *reactor_; }
+
+  Task<Expected<size_t>> read(std::span<std::byte> buf) override {
+    return retry_(false, [this, buf] {
+      return ::read(fd_, buf.data(), buf.size());
+    });
+  }
+
+  Task<Expected<size_t>> write(std::span<const std::byte> buf) override {
+    return retry_(true, [this, buf] {
+      return ::write(fd_, buf.data(), buf.size());
+    });
+  }
+
+  Task<Expected<void>> flush() override { co_return Expected<void>{}; }
+
+  // Closes the descriptor early, e.g. so the peer sees end of stream.
+  void close() {
+    if (fd_ < 0)
+      return;
+    reactor_->remove(fd_);
+    if (owned_)
+      ::close(fd_);
+    fd_ = -1;
+    owned_ = false;
+  }
+};
+} // namespace io
@@ -0,0 +1,299 @@
+#pragma once
+#include "io.hpp"
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Binary encodings selected by wrapping the value:
+//
+//   w << io::binary(header) << io::varint(id) << io::binary(name);
+//   r >> io::binary(header) >> io::varint(id) >> io::binary(name);
+//
+// binary() stores trivially copyable values as their raw little-endian
+// bytes, strings as a varint length and the characters, and vectors as a
+// varint count and the elements; vectors of trivially copyable elements
+// move as one block. varint() stores integers as LEB128, zigzag encoded
+// when signed.
+namespace io {
+static_assert(std::endian::native == std::endian::little,
+              "binary encoding is only implemented for little-endian hosts");
+
+template <typename T>
+struct Binary {
+  T& value;
+};
+
+template <typename T>
+concept VarintInteger =
+    std::integral<T> && !std::same_as<std::remove_const_t<T>, bool>;
+
+template <VarintInteger T>
+struct Varint {
+  T& value;
+};
+
+template <typename T>
+Binary<T> binary(T& value) {
+  return {value};
+}
+
+template <VarintInteger T>
+Varint<T> varint(T& value) {
+  return {value};
+}
+
+namespace detail {
+inline constexpr size_t max_varint = 10;
+// Lengths are read in steps of this many bytes, so a corrupt length
+// fails at the end of the stream rather than in one huge allocation.
+inline constexpr size_t binary_read_step = 1 << 20;
+
+// Small values go straight into the writer's buffer.
+inline Expected<void> write_bytes(Writer& w, const void* src, size_t n) {
+  if (auto* bw = w.write_buffer(); bw && n <= 64) {
+    auto buf = bw->reserve(n);
+    if (!buf)
+      return Unexpected(buf.error());
+    if (!buf->empty()) {
+      std::memcpy(buf->data(), src, n);
+      bw->commit(n);
+      return {};
+    }
+  }
+  return w.write_all(std::span(static_cast<const std::byte*>(src), n));
+}
+
+inline Expected<void> read_bytes(Reader& r, void* dest, size_t n) {
+  if (auto* br = r.buffered()) {
+    auto buf = br->fill_buf();
+    if (!buf)
+      return Unexpected(buf.error());
+    if (buf->size() >= n) {
+      std::memcpy(dest, buf->data(), n);
+      br->consume(n);
+      return {};
+    }
+  }
+  return r.read_exact(std::span(static_cast<std::byte*>(dest), n));
+}
+
+inline size_t encode_varint(uint64_t v, uint8_t* out) {
+  size_t n = 0;
+  for (; v >= 0x80; v >>= 7)
+    out[n++] = static_cast<uint8_t>(v | 0x80);
+  out[n++] = static_cast<uint8_t>(v);
+  return n;
+}
+
+// Decodes from at most max_varint bytes; returns the number used, or 0
+// if the encoding is longer or does not fit 64 bits.
+inline size_t decode_varint(const uint8_t* in, size_t avail, uint64_t& v) {
+  v = 0;
+  for (size_t i = 0; i < std::min(avail, max_varint); i++) {
+    uint64_t bits = in[i] & 0x7F;
+    if (i == max_varint - 1 && bits > 1)
+      return 0;
+    v |= bits << (7 * i);
+    if (!(in[i] & 0x80))
+      return i + 1;
+  }
+  return 0;
+}
+
+inline Expected<void> write_varint(Writer& w, uint64_t v) {
+  uint8_t buf[max_varint];
+  return write_bytes(w, buf, encode_varint(v, buf));
+}
+
+inline Expected<uint64_t> read_varint(Reader& r) {
+  uint64_t v;
+  if (auto* br = r.buffered()) {
+    auto buf = br->fill_buf();
+    if (!buf)
+      return Unexpected(buf.error());
+    auto p = reinterpret_cast<const uint8_t*>(buf->data());
+    if (size_t n = decode_varint(p, buf->size(), v)) {
+      br->consume(n);
+      return v;
+    }
+    if (buf->size() >= max_varint)
+      return Unexpected(Err::InvalidData);
+  }
+  uint8_t bytes[max_varint];
+  for (size_t i = 0; i < max_varint; i++) {
+    auto res = read_bytes(r, &bytes[i], 1);
+    if (!res)
+      return Unexpected(res.error());
+    if (!(bytes[i] & 0x80)) {
+      if (!decode_varint(bytes, i + 1, v))
+        return Unexpected(Err::InvalidData);
+      return v;
+    }
+  }
+  return Unexpected(Err::InvalidData);
+}
+
+template <typename T>
+Expected<size_t> read_length(Reader& r) {
+  auto n = read_varint(r);
+  if (!n)
+    return Unexpected(n.error());
+  if (*n > SIZE_MAX / sizeof(T))
+    return Unexpected(Err::InvalidData);
+  return static_cast<size_t>(*n);
+}
+} // namespace detail
+
+template <typename T>
+  requires std::is_trivially_copyable_v<std::remove_const_t<T>>
+class WriteFrom<Binary<T>> {
+public:
+  static Expected<void> write_from(Writer& w, const Binary<T>& src) {
+    return detail::write_bytes(w, &src.value, sizeof(T));
+  }
+};
+
+template <typename T>
+  requires std::is_trivially_copyable_v<T>
+class ReadInto<Binary<T>> {
+public:
+  static Expected<void> read_into(Reader& r, Binary<T>& dest) {
+    return detail::read_bytes(r, &dest.value, sizeof(T));
+  }
+};
+
+template <typename T>
+  requires std::same_as<std::remove_const_t<T>, std::string>
+class WriteFrom<Binary<T>> {
+public:
+  static Expected<void> write_from(Writer& w, const Binary<T>& src) {
+    auto res = detail::write_varint(w, src.value.size());
+    if (!res)
+      return res;
+    return detail::write_bytes(w, src.value.data(), src.value.size());
+  }
+};
+
+template <>
+class ReadInto<Binary<std::string>> {
+public:
+  static Expected<void> read_into(Reader& r, Binary<std::string>& dest) {
+    auto n = detail::read_length<char>(r);
+    if (!n)
+      return Unexpected(n.error());
+    std::string& s = dest.value;
+    s.clear();
+    for (size_t done = 0; done < *n;) {
+      size_t step = std::min(*n - done, detail::binary_read_step);
+      s.resize(done + step);
+      auto res = detail::read_bytes(r, s.data() + done, step);
+      if (!res)
+        return res;
+      done += step;
+    }
+    return {};
+  }
+};
+
+template <typename T>
+class WriteFrom<Binary<const std::vector<T>>> {
+public:
+  static Expected<void> write_from(Writer& w,
+                                   const Binary<const std::vector<T>>& src) {
+    auto& v = src.value;
+    auto res = detail::write_varint(w, v.size());
+    if (!res)
+      return res;
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      return detail::write_bytes(w, v.data(), v.size() * sizeof(T));
+    } else {
+      for (auto& item : v) {
+        auto item_res = w.write_from(binary(item));
+        if (!item_res)
+          return item_res;
+      }
+      return {};
+    }
+  }
+};
+
+template <typename T>
+class WriteFrom<Binary<std::vector<T>>> {
+public:
+  static Expected<void> write_from(Writer& w,
+                                   const Binary<std::vector<T>>& src) {
+    const std::vector<T>& v = src.value;
+    return w.write_from(binary(v));
+  }
+};
+
+template <typename T>
+class ReadInto<Binary<std::vector<T>>> {
+public:
+  static Expected<void> read_into(Reader& r, Binary<std::vector<T>>& dest) {
+    auto n = detail::read_length<T>(r);
+    if (!n)
+      return Unexpected(n.error());
+    auto& v = dest.value;
+    v.clear();
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      size_t step_items =
+          std::max<size_t>(1, detail::binary_read_step / sizeof(T));
+      for (size_t done = 0; done < *n;) {
+        size_t step = std::min(*n - done, step_items);
+        v.resize(done + step);
+        auto res = detail::read_bytes(r, v.data() + done, step * sizeof(T));
+        if (!res)
+          return res;
+        done += step;
+      }
+    } else {
+      for (size_t i = 0; i < *n; i++) {
+        auto res = r.read_into(binary(v.emplace_back()));
+        if (!res)
+          return res;
+      }
+    }
+    return {};
+  }
+};
+
+template <VarintInteger T>
+class WriteFrom<Varint<T>> {
+public:
+  static Expected<void> write_from(Writer& w, const Varint<T>& src) {
+    using U = std::make_unsigned_t<std::remove_const_t<T>>;
+    U u = static_cast<U>(src.value);
+    if constexpr (std::is_signed_v<T>) {
+      U sign = static_cast<U>(src.value >> (sizeof(T) * 8 - 1));
+      u = static_cast<U>((u << 1) ^ sign);
+    }
+    return detail::write_varint(w, u);
+  }
+};
+
+template <VarintInteger T>
+class ReadInto<Varint<T>> {
+public:
+  static Expected<void> read_into(Reader& r, Varint<T>& dest) {
+    using U = std::make_unsigned_t<T>;
+    auto v = detail::read_varint(r);
+    if (!v)
+      return Unexpected(v.error());
+    if (*v > std::numeric_limits<U>::max())
+      return Unexpected(Err::InvalidData);
+    U u = static_cast<U>(*v);
+    if constexpr (std::is_signed_v<T>)
+      dest.value = static_cast<T>((u >> 1) ^ (~(u & 1) + 1));
+    else
+      dest.value = u;
+    return {};
+  }
+};
+} // namespace io
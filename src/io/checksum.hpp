@@ -0,0 +1,318 @@
+#pragma once
+#include "io.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define IO_CRC32C_SSE42 1
+#endif
+
+// CRC32C (Castagnoli) checksums and pass-through streams that compute
+// them. Where possible the checksum is taken while the bytes are copied
+// into or out of a buffer, so the data is only touched once.
+namespace io {
+namespace detail {
+inline constexpr uint32_t crc32c_poly = 0x82F63B78; // reflected
+
+// Slicing-by-8: table[k][b] is the CRC of byte b followed by k zeros.
+constexpr std::array<std::array<uint32_t, 256>, 8> make_crc32c_table() {
+  std::array<std::array<uint32_t, 256>, 8> table{};
+  for (uint32_t b = 0; b < 256; b++) {
+    uint32_t crc = b;
+    for (int i = 0; i < 8; i++)
+      crc = crc & 1 ? (crc >> 1) ^ crc32c_poly : crc >> 1;
+    table[0][b] = crc;
+  }
+  for (uint32_t b = 0; b < 256; b++)
+    for (int k = 1; k < 8; k++)
+      table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xFF];
+  return table;
+}
+
+inline constexpr auto crc32c_table = make_crc32c_table();
+
+// Updates a raw (uninverted) CRC with n bytes from src, also copying them
+// to dst when it is not null.
+inline uint32_t crc32c_portable(uint32_t crc, const std::byte* src,
+                                std::byte* dst, size_t n) {
+  auto& t = crc32c_table;
+  for (; n >= 8; n -= 8, src += 8) {
+    uint64_t word;
+    std::memcpy(&word, src, 8);
+    if (dst) {
+      std::memcpy(dst, &word, 8);
+      dst += 8;
+    }
+    if constexpr (std::endian::native == std::endian::big)
+      word = __builtin_bswap64(word);
+    uint32_t lo = static_cast<uint32_t>(word) ^ crc;
+    uint32_t hi = static_cast<uint32_t>(word >> 32);
+    crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^
+          t[4][lo >> 24] ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^
+          t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+  }
+  for (; n > 0; n--, src++) {
+    if (dst)
+      *dst++ = *src;
+    crc = (crc >> 8) ^ t[0][(crc ^ std::to_integer<uint32_t>(*src)) & 0xFF];
+  }
+  return crc;
+}
+
+#ifdef IO_CRC32C_SSE42
+// Multiplying a CRC by x^(8 * len) appends len zero bytes to the data it
+// covers; done over GF(2) with 32x32 bit matrices, then tabulated per
+// byte of the CRC so the shift costs four lookups.
+constexpr uint32_t gf2_times(const std::array<uint32_t, 32>& mat,
+                             uint32_t vec) {
+  uint32_t sum = 0;
+  for (int i = 0; vec; i++, vec >>= 1)
+    if (vec & 1)
+      sum ^= mat[i];
+  return sum;
+}
+
+constexpr std::array<std::array<uint32_t, 256>, 4>
+make_crc32c_shift(size_t len) {
+  std::array<uint32_t, 32> op{}, square{};
+  op[0] = crc32c_poly; // one zero bit
+  for (int i = 1; i < 32; i++)
+    op[i] = 1u << (i - 1);
+  // Square up to one zero byte, then by repeated squaring to len bytes.
+  std::array<uint32_t, 32> result{};
+  for (int i = 0; i < 32; i++)
+    result[i] = 1u << i;
+  for (int k = 0; k < 3; k++) {
+    for (int i = 0; i < 32; i++)
+      square[i] = gf2_times(op, op[i]);
+    op = square;
+  }
+  for (; len; len >>= 1) {
+    if (len & 1) {
+      for (int i = 0; i < 32; i++)
+        square[i] = gf2_times(op, result[i]);
+      result = square;
+    }
+    for (int i = 0; i < 32; i++)
+      square[i] = gf2_times(op, op[i]);
+    op = square;
+  }
+  std::array<std::array<uint32_t, 256>, 4> table{};
+  for (uint32_t b = 0; b < 256; b++)
+    for (int k = 0; k < 4; k++)
+      table[k][b] = gf2_times(result, b << (8 * k));
+  return table;
+}
+
+// Each of the three lanes is this long; the crc32 instruction has a
+// latency of three cycles and a throughput of one, so three independent
+// streams keep it busy.
+inline constexpr size_t crc32c_lane = 4096;
+inline constexpr auto crc32c_lane_shift = make_crc32c_shift(crc32c_lane);
+
+inline uint32_t crc32c_shift(uint32_t crc) {
+  auto& t = crc32c_lane_shift;
+  return t[0][crc & 0xFF] ^ t[1][(crc >> 8) & 0xFF] ^
+         t[2][(crc >> 16) & 0xFF] ^ t[3][crc >> 24];
+}
+
+__attribute__((target("sse4.2"))) inline uint32_t
+crc32c_sse42_(uint32_t crc32, const std::byte* src, size_t n) {
+  auto word = [](const std::byte* p) {
+    uint64_t w;
+    std::memcpy(&w, p, 8);
+    return w;
+  };
+  uint64_t crc = crc32;
+  for (; n > 0 && reinterpret_cast<uintptr_t>(src) % 8; n--)
+    crc = _mm_crc32_u8(static_cast<uint32_t>(crc),
+                       std::to_integer<uint8_t>(*src++));
+  constexpr size_t L = crc32c_lane;
+  for (; n >= 3 * L; n -= 3 * L, src += 3 * L) {
+    uint64_t crc1 = 0, crc2 = 0;
+    for (size_t i = 0; i < L; i += 8) {
+      crc = _mm_crc32_u64(crc, word(src + i));
+      crc1 = _mm_crc32_u64(crc1, word(src + L + i));
+      crc2 = _mm_crc32_u64(crc2, word(src + 2 * L + i));
+    }
+    crc = crc32c_shift(static_cast<uint32_t>(crc)) ^ crc1;
+    crc = crc32c_shift(static_cast<uint32_t>(crc)) ^ crc2;
+  }
+  for (; n >= 8; n -= 8, src += 8)
+    crc = _mm_crc32_u64(crc, word(src));
+  for (; n > 0; n--)
+    crc = _mm_crc32_u8(static_cast<uint32_t>(crc),
+                       std::to_integer<uint8_t>(*src++));
+  return static_cast<uint32_t>(crc);
+}
+
+// Copies go through memcpy, which uses the widest stores, one L1-sized
+// piece at a time; each piece is checksummed while it is still in cache.
+// Storing words from inside the crc loop measured slower.
+inline uint32_t crc32c_sse42(uint32_t crc, const std::byte* src,
+                             std::byte* dst, size_t n) {
+  if (!dst)
+    return crc32c_sse42_(crc, src, n);
+  constexpr size_t piece = 3 * crc32c_lane;
+  for (; n > 0; src += piece, dst += piece) {
+    size_t step = std::min(n, piece);
+    std::memcpy(dst, src, step);
+    crc = crc32c_sse42_(crc, src, step);
+    n -= step;
+  }
+  return crc;
+}
+#endif
+
+inline uint32_t crc32c_update(uint32_t crc, const std::byte* src,
+                              std::byte* dst, size_t n) {
+#ifdef IO_CRC32C_SSE42
+  static const bool hw = __builtin_cpu_supports("sse4.2");
+  if (hw)
+    return crc32c_sse42(crc, src, dst, n);
+#endif
+  return crc32c_portable(crc, src, dst, n);
+}
+} // namespace detail
+
+// Pass the previous result as crc to extend a checksum:
+// crc32c(b, crc32c(a)) == crc32c(a + b).
+inline uint32_t crc32c(std::span<const std::byte> data, uint32_t crc = 0) {
+  return ~detail::crc32c_update(~crc, data.data(), nullptr, data.size());
+}
+
+// Copies src to the front of dst and returns the extended checksum.
+inline uint32_t crc32c_copy(std::span<std::byte> dst,
+                            std::span<const std::byte> src,
+                            uint32_t crc = 0) {
+  return ~detail::crc32c_update(~crc, src.data(), dst.data(), src.size());
+}
+
+// Checksums everything written through it. When the inner writer has a
+// buffer the bytes are checksummed as they are copied into it, and
+// formatted output reserved from this writer is checksummed on commit.
+class ChecksumWriter : public Writer, public BufWrite {
+  Writer& inner_;
+  BufWrite* buffer_;
+  std::span<std::byte> reserved_;
+  uint32_t crc_ = 0;
+
+public:
+  explicit ChecksumWriter(Writer& inner, uint32_t crc = 0)
+      : inner_(inner), buffer_(inner.write_buffer()), crc_(crc) {}
+
+  uint32_t checksum() const { return crc_; }
+  void reset(uint32_t crc = 0) { crc_ = crc; }
+
+  Expected<size_t> write(std::span<const std::byte> buf) override {
+    if (buffer_ && !buf.empty()) {
+      auto space = buffer_->reserve(1);
+      if (!space)
+        return Unexpected(space.error());
+      if (!space->empty()) {
+        size_t n = std::min(buf.size(), space->size());
+        crc_ = crc32c_copy(*space, buf.first(n), crc_);
+        buffer_->commit(n);
+        return n;
+      }
+    }
+    auto res = inner_.write(buf);
+    if (res)
+      crc_ = crc32c(buf.first(*res), crc_);
+    return res;
+  }
+
+  // Over an unbuffered writer nothing can be reserved.
+  Expected<std::span<std::byte>> reserve(size_t n) override {
+    if (!buffer_)
+      return std::span<std::byte>();
+    auto space = buffer_->reserve(n);
+    if (space)
+      reserved_ = *space;
+    return space;
+  }
+
+  void commit(size_t n) override {
+    n = std::min(n, reserved_.size());
+    crc_ = crc32c(reserved_.first(n), crc_);
+    reserved_ = {};
+    if (buffer_)
+      buffer_->commit(n);
+  }
+
+  BufWrite* write_buffer() override { return buffer_ ? this : nullptr; }
+  Expected<void> flush() override { return inner_.flush(); }
+};
+
+// Checksums everything read through it. Over a buffered reader the
+// bytes are checksummed as they are copied out, or on consume() when
+// parsed in place. Over an unbuffered one, fill_buf() reads into a
+// small buffer of its own.
+class ChecksumReader : public Reader, public BufRead {
+  Reader& inner_;
+  BufRead* buffer_;
+  std::span<const std::byte> filled_;
+  uint32_t crc_ = 0;
+  std::array<std::byte, 256> local_;
+
+public:
+  explicit ChecksumReader(Reader& inner, uint32_t crc = 0)
+      : inner_(inner), buffer_(inner.buffered()), crc_(crc) {}
+
+  uint32_t checksum() const { return crc_; }
+  void reset(uint32_t crc = 0) { crc_ = crc; }
+
+  Expected<size_t> read(std::span<std::byte> buf) override {
+    if (!buffer_) {
+      if (!filled_.empty()) {
+        size_t n = std::min(buf.size(), filled_.size());
+        crc_ = crc32c_copy(buf, filled_.first(n), crc_);
+        filled_ = filled_.subspan(n);
+        return n;
+      }
+      auto res = inner_.read(buf);
+      if (res)
+        crc_ = crc32c(buf.first(*res), crc_);
+      return res;
+    }
+    auto avail = buffer_->fill_buf();
+    if (!avail)
+      return Unexpected(avail.error());
+    size_t n = std::min(buf.size(), avail->size());
+    crc_ = crc32c_copy(buf, avail->first(n), crc_);
+    buffer_->consume(n);
+    filled_ = {};
+    return n;
+  }
+
+  Expected<std::span<const std::byte>> fill_buf() override {
+    if (!buffer_) {
+      if (filled_.empty()) {
+        auto n = inner_.read(local_);
+        if (!n)
+          return Unexpected(n.error());
+        filled_ = std::span(local_).first(*n);
+      }
+      return filled_;
+    }
+    auto avail = buffer_->fill_buf();
+    if (avail)
+      filled_ = *avail;
+    return avail;
+  }
+
+  void consume(size_t n) override {
+    n = std::min(n, filled_.size());
+    crc_ = crc32c(filled_.first(n), crc_);
+    filled_ = filled_.subspan(n);
+    if (buffer_)
+      buffer_->consume(n);
+  }
+
+  BufRead* buffered() override { return buffer_ ? this : nullptr; }
+};
+} // namespace io
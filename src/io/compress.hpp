@@ -0,0 +1,478 @@
+#pragma once
+#include "../parallel.hpp"
+#include "io.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Streaming compression in an LZ4-style block format. The stream is a
+// magic number followed by independent blocks, each with an 8-byte
+// header: the payload size (top bit set when the block is stored raw)
+// and the decompressed size. Blocks share no history, so both sides
+// work on several at once.
+namespace io {
+struct CompressOptions {
+  size_t block_size = 1 << 18;
+  // Candidates tried per position; more finds longer matches, slower.
+  unsigned max_chain = 8;
+  unsigned threads = 0;
+};
+
+namespace detail {
+inline constexpr std::array<std::byte, 4> lz_magic = {
+    std::byte{'P'}, std::byte{'L'}, std::byte{'Z'}, std::byte{'1'}};
+inline constexpr uint32_t lz_raw_flag = 0x80000000u;
+inline constexpr size_t lz_max_block = 1 << 26;
+inline constexpr size_t lz_min_match = 4;
+// As in LZ4, the last match starts at least 12 bytes before the end and
+// the last 5 bytes are always literals.
+inline constexpr size_t lz_match_margin = 12;
+inline constexpr size_t lz_tail_literals = 5;
+inline constexpr int lz_hash_bits = 16;
+inline constexpr size_t lz_window = 1 << 16;
+
+inline uint32_t lz_load32(const uint8_t* p) {
+  uint32_t v;
+  std::memcpy(&v, p, 4);
+  return v;
+}
+
+inline uint32_t lz_hash(uint32_t v) {
+  return (v * 2654435761u) >> (32 - lz_hash_bits);
+}
+
+inline void lz_store_le32(std::byte* p, uint32_t v) {
+  for (int i = 0; i < 4; i++)
+    p[i] = std::byte(v >> (8 * i));
+}
+
+inline uint32_t lz_load_le32(const std::byte* p) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; i++)
+    v |= std::to_integer<uint32_t>(p[i]) << (8 * i);
+  return v;
+}
+
+// Length of the common prefix of a and b, which are at least four bytes
+// apart and equal in their first four; b may not pass end.
+inline size_t lz_match_length(const uint8_t* a, const uint8_t* b,
+                              const uint8_t* end) {
+  size_t len = lz_min_match;
+  while (b + len + 8 <= end) {
+    uint64_t x, y;
+    std::memcpy(&x, a + len, 8);
+    std::memcpy(&y, b + len, 8);
+    if (x != y) {
+      int bits = std::endian::native == std::endian::little
+                     ? std::countr_zero(x ^ y)
+                     : std::countl_zero(x ^ y);
+      return len + static_cast<size_t>(bits / 8);
+    }
+    len += 8;
+  }
+  while (b + len < end && a[len] == b[len])
+    len++;
+  return len;
+}
+
+inline uint8_t* lz_put_length(uint8_t* op, size_t len) {
+  for (; len >= 255; len -= 255)
+    *op++ = 255;
+  *op++ = static_cast<uint8_t>(len);
+  return op;
+}
+
+// Per-thread match finder state: the newest position for each hash and,
+// for each position in the window, the previous one with the same hash.
+struct LzScratch {
+  std::vector<int32_t> head = std::vector<int32_t>(size_t(1) << lz_hash_bits);
+  std::vector<int32_t> chain = std::vector<int32_t>(lz_window);
+};
+
+// Returns the compressed size, or 0 when the output would not be smaller
+// than the input.
+inline size_t lz_compress(std::span<const std::byte> in, std::byte* out,
+                          unsigned max_chain, LzScratch& s) {
+  auto src = reinterpret_cast<const uint8_t*>(in.data());
+  auto op = reinterpret_cast<uint8_t*>(out);
+  const uint8_t* op_end = op + in.size();
+  size_t n = in.size(), anchor = 0, i = 0;
+  std::fill(s.head.begin(), s.head.end(), -1);
+
+  auto insert = [&](size_t p) {
+    uint32_t h = lz_hash(lz_load32(src + p));
+    s.chain[p & (lz_window - 1)] = s.head[h];
+    s.head[h] = static_cast<int32_t>(p);
+  };
+  // Token, length bytes and offset around the literals.
+  auto fits = [&](size_t literals, size_t match) {
+    return op + 1 + literals + literals / 255 + 1 + 2 + match / 255 + 1 <=
+           op_end;
+  };
+
+  if (n > lz_match_margin) {
+    size_t limit = n - lz_match_margin, match_end = n - lz_tail_literals;
+    while (i < limit) {
+      uint32_t seq = lz_load32(src + i);
+      uint32_t h = lz_hash(seq);
+      int32_t cand = s.head[h];
+      s.chain[i & (lz_window - 1)] = cand;
+      s.head[h] = static_cast<int32_t>(i);
+
+      size_t best = 0, best_offset = 0;
+      for (unsigned steps = max_chain;
+           cand >= 0 && i - cand < lz_window && steps > 0;
+           steps--, cand = s.chain[cand & (lz_window - 1)]) {
+        // A candidate can only beat the best so far if it agrees one
+        // byte past it.
+        if ((best && (i + best >= match_end ||
+                      src[cand + best] != src[i + best])) ||
+            lz_load32(src + cand) != seq)
+          continue;
+        size_t len = lz_match_length(src + cand, src + i, src + match_end);
+        if (len > best) {
+          best = len;
+          best_offset = i - cand;
+        }
+      }
+      if (best == 0) {
+        // Skip faster through data that does not compress.
+        i += 1 + ((i - anchor) >> 6);
+        continue;
+      }
+
+      size_t literals = i - anchor;
+      if (!fits(literals, best))
+        return 0;
+      uint8_t* token = op++;
+      size_t ml = best - lz_min_match;
+      *token = static_cast<uint8_t>((std::min<size_t>(literals, 15) << 4) |
+                                    std::min<size_t>(ml, 15));
+      if (literals >= 15)
+        op = lz_put_length(op, literals - 15);
+      std::memcpy(op, src + anchor, literals);
+      op += literals;
+      *op++ = static_cast<uint8_t>(best_offset);
+      *op++ = static_cast<uint8_t>(best_offset >> 8);
+      if (ml >= 15)
+        op = lz_put_length(op, ml - 15);
+
+      for (size_t p = i + 1; p < std::min(i + best, limit); p++)
+        insert(p);
+      i += best;
+      anchor = i;
+    }
+  }
+
+  size_t literals = n - anchor;
+  if (!fits(literals, 0))
+    return 0;
+  *op++ = static_cast<uint8_t>(std::min<size_t>(literals, 15) << 4);
+  if (literals >= 15)
+    op = lz_put_length(op, literals - 15);
+  std::memcpy(op, src + anchor, literals);
+  op += literals;
+  return static_cast<size_t>(op - reinterpret_cast<uint8_t*>(out));
+}
+
+// Fails unless the input decodes to exactly out.size() bytes; every
+// length and offset is checked, so corrupt input cannot overrun.
+inline bool lz_decompress(std::span<const std::byte> in,
+                          std::span<std::byte> out) {
+  auto ip = reinterpret_cast<const uint8_t*>(in.data());
+  const uint8_t* ip_end = ip + in.size();
+  auto op = reinterpret_cast<uint8_t*>(out.data());
+  uint8_t* const op_begin = op;
+  uint8_t* const op_end = op + out.size();
+
+  auto get_length = [&](size_t& len) {
+    uint8_t b;
+    do {
+      if (ip == ip_end)
+        return false;
+      b = *ip++;
+      len += b;
+    } while (b == 255);
+    return true;
+  };
+
+  while (ip < ip_end) {
+    uint8_t token = *ip++;
+    size_t literals = token >> 4;
+    if (literals == 15 && !get_length(literals))
+      return false;
+    if (literals > size_t(ip_end - ip) || literals > size_t(op_end - op))
+      return false;
+    // Short runs are copied as one fixed 16-byte move when there is room
+    // to spill; the excess is overwritten by what follows.
+    if (literals <= 16 && ip_end - ip >= 16 && op_end - op >= 16)
+      std::memcpy(op, ip, 16);
+    else
+      std::memcpy(op, ip, literals);
+    ip += literals;
+    op += literals;
+    if (ip == ip_end)
+      break;
+
+    if (ip_end - ip < 2)
+      return false;
+    size_t offset = ip[0] | size_t(ip[1]) << 8;
+    ip += 2;
+    size_t len = token & 15;
+    if (len == 15 && !get_length(len))
+      return false;
+    len += lz_min_match;
+    if (offset == 0 || offset > size_t(op - op_begin) ||
+        len > size_t(op_end - op))
+      return false;
+    const uint8_t* match = op - offset;
+    if (offset >= 8 && size_t(op_end - op) >= len + 8) {
+      // Each 8-byte step reads only bytes already in place.
+      for (size_t k = 0; k < len; k += 8)
+        std::memcpy(op + k, match + k, 8);
+      op += len;
+    } else if (offset >= len) {
+      std::memcpy(op, match, len);
+      op += len;
+    } else {
+      // Overlapping copies repeat the last offset bytes.
+      for (size_t k = 0; k < len; k++)
+        *op++ = match[k];
+    }
+  }
+  return op == op_end;
+}
+} // namespace detail
+
+// Collects up to threads blocks, compresses them in parallel and writes
+// them in order. flush() emits the partial batch, so the stream is
+// complete after it; the destructor flushes too.
+class CompressWriter : public Writer, public BufWrite {
+  static constexpr size_t header_size = 8;
+
+  Writer& inner_;
+  CompressOptions opts_;
+  std::vector<std::byte> in_;
+  size_t len_ = 0;
+  std::vector<std::vector<std::byte>> out_;
+  std::vector<size_t> out_size_;
+  bool started_ = false;
+
+  Expected<void> compress_batch_() {
+    size_t blocks = (len_ + opts_.block_size - 1) / opts_.block_size;
+    lib::parallel_for(
+        blocks,
+        [&](size_t begin, size_t end) {
+          detail::LzScratch scratch;
+          for (size_t b = begin; b < end; b++) {
+            size_t offset = b * opts_.block_size;
+            auto block = std::span<const std::byte>(in_).subspan(
+                offset, std::min(opts_.block_size, len_ - offset));
+            std::byte* out = out_[b].data();
+            size_t n = detail::lz_compress(block, out + header_size,
+                                           opts_.max_chain, scratch);
+            uint32_t stored = static_cast<uint32_t>(n);
+            if (n == 0) {
+              std::copy(block.begin(), block.end(), out + header_size);
+              n = block.size();
+              stored = static_cast<uint32_t>(n) | detail::lz_raw_flag;
+            }
+            detail::lz_store_le32(out, stored);
+            detail::lz_store_le32(out + 4, static_cast<uint32_t>(block.size()));
+            out_size_[b] = header_size + n;
+          }
+        },
+        opts_.threads);
+
+    std::vector<std::span<const std::byte>> slices;
+    if (!started_)
+      slices.push_back(detail::lz_magic);
+    for (size_t b = 0; b < blocks; b++)
+      slices.emplace_back(out_[b].data(), out_size_[b]);
+    auto res = inner_.write_all_vectored(slices);
+    if (!res)
+      return res;
+    started_ = true;
+    len_ = 0;
+    return {};
+  }
+
+public:
+  CompressWriter(Writer& inner, CompressOptions opts = {})
+      : inner_(inner), opts_(opts) {
+    opts_.block_size =
+        std::clamp<size_t>(opts_.block_size, 64, detail::lz_max_block);
+    if (opts_.threads == 0)
+      opts_.threads = lib::hardware_threads();
+    in_.resize(opts_.block_size * opts_.threads);
+    out_.resize(opts_.threads,
+                std::vector<std::byte>(header_size + opts_.block_size));
+    out_size_.resize(opts_.threads);
+  }
+
+  ~CompressWriter() { flush(); }
+
+  Expected<size_t> write(std::span<const std::byte> buf) override {
+    size_t total = buf.size();
+    while (!buf.empty()) {
+      if (len_ == in_.size()) {
+        auto res = compress_batch_();
+        if (!res)
+          return Unexpected(res.error());
+      }
+      size_t n = std::min(buf.size(), in_.size() - len_);
+      std::copy_n(buf.data(), n, in_.data() + len_);
+      len_ += n;
+      buf = buf.subspan(n);
+    }
+    return total;
+  }
+
+  Expected<std::span<std::byte>> reserve(size_t n) override {
+    if (n > in_.size())
+      return std::span<std::byte>();
+    if (in_.size() - len_ < n) {
+      auto res = compress_batch_();
+      if (!res)
+        return Unexpected(res.error());
+    }
+    return std::span(in_).subspan(len_);
+  }
+
+  void commit(size_t n) override { len_ = std::min(len_ + n, in_.size()); }
+  BufWrite* write_buffer() override { return this; }
+
+  Expected<void> flush() override {
+    if (len_ == 0 && started_)
+      return {};
+    return compress_batch_();
+  }
+};
+
+// Reads up to threads blocks ahead and decompresses them in parallel.
+// Decoded bytes are served in place through BufRead. A stream that ends
+// inside a block is UnexpectedEof; a bad header or payload is
+// InvalidData.
+class DecompressReader : public Reader, public BufRead {
+  Reader& inner_;
+  unsigned threads_;
+  bool started_ = false, eof_ = false;
+  std::vector<std::vector<std::byte>> in_, out_;
+  std::vector<uint32_t> stored_;
+  size_t blocks_ = 0, cur_ = 0, pos_ = 0;
+
+  // Reads exactly buf.size() bytes, or nothing at a clean end of stream.
+  Expected<bool> read_header_(std::span<std::byte> buf) {
+    size_t got = 0;
+    while (got < buf.size()) {
+      auto res = inner_.read(buf.subspan(got));
+      if (!res)
+        return Unexpected(res.error());
+      if (*res == 0) {
+        if (got == 0)
+          return false;
+        return Unexpected(Err::UnexpectedEof);
+      }
+      got += *res;
+    }
+    return true;
+  }
+
+  Expected<void> fill_batch_() {
+    cur_ = pos_ = blocks_ = 0;
+    if (!started_) {
+      std::array<std::byte, 4> magic;
+      auto res = read_header_(magic);
+      if (!res)
+        return Unexpected(res.error());
+      if (!*res) {
+        eof_ = true;
+        return {};
+      }
+      if (magic != detail::lz_magic)
+        return Unexpected(Err::InvalidData);
+      started_ = true;
+    }
+    while (blocks_ < threads_) {
+      std::array<std::byte, 8> header;
+      auto res = read_header_(header);
+      if (!res)
+        return Unexpected(res.error());
+      if (!*res) {
+        eof_ = true;
+        break;
+      }
+      uint32_t stored = detail::lz_load_le32(header.data());
+      size_t payload = stored & ~detail::lz_raw_flag;
+      size_t raw = detail::lz_load_le32(header.data() + 4);
+      if (raw > detail::lz_max_block || payload > detail::lz_max_block ||
+          ((stored & detail::lz_raw_flag) && payload != raw))
+        return Unexpected(Err::InvalidData);
+      in_[blocks_].resize(payload);
+      auto body = inner_.read_exact(in_[blocks_]);
+      if (!body)
+        return body;
+      out_[blocks_].resize(raw);
+      stored_[blocks_] = stored;
+      blocks_++;
+    }
+
+    std::atomic<bool> ok = true;
+    lib::parallel_for(
+        blocks_,
+        [&](size_t begin, size_t end) {
+          for (size_t b = begin; b < end; b++) {
+            if (stored_[b] & detail::lz_raw_flag)
+              in_[b].swap(out_[b]);
+            else if (!detail::lz_decompress(in_[b], out_[b]))
+              ok = false;
+          }
+        },
+        threads_);
+    if (!ok)
+      return Unexpected(Err::InvalidData);
+    return {};
+  }
+
+public:
+  DecompressReader(Reader& inner, unsigned threads = 0)
+      : inner_(inner), threads_(threads ? threads : lib::hardware_threads()),
+        in_(threads_), out_(threads_), stored_(threads_) {}
+
+  BufRead* buffered() override { return this; }
+
+  Expected<std::span<const std::byte>> fill_buf() override {
+    while (cur_ == blocks_ || pos_ == out_[cur_].size()) {
+      if (cur_ < blocks_) {
+        cur_++, pos_ = 0;
+        continue;
+      }
+      if (eof_)
+        return std::span<const std::byte>();
+      auto res = fill_batch_();
+      if (!res)
+        return Unexpected(res.error());
+    }
+    return std::span<const std::byte>(out_[cur_]).subspan(pos_);
+  }
+
+  void consume(size_t n) override {
+    if (cur_ < blocks_)
+      pos_ = std::min(pos_ + n, out_[cur_].size());
+  }
+
+  Expected<size_t> read(std::span<std::byte> buf) override {
+    auto avail = fill_buf();
+    if (!avail)
+      return Unexpected(avail.error());
+    size_t n = std::min(buf.size(), avail->size());
+    std::copy_n(avail->data(), n, buf.data());
+    consume(n);
+    return n;
+  }
+};
+} // namespace io
@@ -1,7 +1,9 @@
 #pragma once
+#include <algorithm>
 #include <cctype>
 #include <charconv>
 #include <concepts>
+#include <cstring>
 #include <cstddef>
 #include <expected>
 #include <format>
@@ -24,7 +26,9 @@ using Expected = std::expected<T, Err>;
 using Unexpected = std::unexpected<Err>;
 
 class Reader;
+class BufRead;
 class Writer;
+class BufWrite;
 class ReaderWriter;
 template <typename T>
 class ReadInto;
@@ -34,12 +38,20 @@ class WriteFrom;
 class Reader {
 public:
   virtual Expected<size_t> read(std::span<std::byte> buf) = 0;
+  // Scatter read; the default fills only the first non-empty buffer.
+  virtual Expected<size_t>
+  read_vectored(std::span<const std::span<std::byte>> bufs);
 
   virtual ~Reader() = default;
   virtual Expected<void> read_exact(std::span<std::byte> buf);
+  // The reader's BufRead side, if it has one; cheaper than a cross cast
+  // on every token.
+  virtual BufRead* buffered() { return nullptr; }
+  // Takes rvalues too, for wrappers such as binary(x) that refer to the
+  // real destination.
   template <typename T>
-  Expected<void> read_into(T& dest) {
-    return ReadInto<T>::read_into(*this, dest);
+  Expected<void> read_into(T&& dest) {
+    return ReadInto<std::remove_cvref_t<T>>::read_into(*this, dest);
   };
 
   class OperatorWrapper {
@@ -51,26 +63,57 @@ public:
   public:
     operator Expected<void>() { return error; }
     template <typename T>
-    OperatorWrapper operator>>(T& dest) {
+    OperatorWrapper operator>>(T&& dest) {
       if (!error.has_value())
         return *this;
-      return OperatorWrapper(r.read_into(dest), r);
+      return OperatorWrapper(r.read_into(std::forward<T>(dest)), r);
     }
   };
 
   template <typename T>
-  OperatorWrapper operator>>(T& dest) {
-    return OperatorWrapper(read_into(dest), *this);
+  OperatorWrapper operator>>(T&& dest) {
+    return OperatorWrapper(read_into(std::forward<T>(dest)), *this);
   };
 };
 
+// Readers that expose their internal buffer, so callers can scan bytes in
+// place. fill_buf() returns the unread buffered bytes, refilling only when
+// there are none; an empty span means end of stream. consume(n) marks the
+// first n of them as read.
+class BufRead {
+public:
+  virtual Expected<std::span<const std::byte>> fill_buf() = 0;
+  virtual void consume(size_t n) = 0;
+
+  virtual ~BufRead() = default;
+};
+
+// Writers that let callers format straight into their buffer. reserve(n)
+// returns at least n writable bytes, flushing first if needed, or an
+// empty span if the buffer can never hold n bytes; commit(n) appends the
+// first n of them.
+class BufWrite {
+public:
+  virtual Expected<std::span<std::byte>> reserve(size_t n) = 0;
+  virtual void commit(size_t n) = 0;
+
+  virtual ~BufWrite() = default;
+};
+
 class Writer {
 public:
   virtual Expected<size_t> write(std::span<const std::byte> buf) = 0;
   virtual Expected<void> flush() = 0;
+  // Gather write; the default writes only the first non-empty buffer.
+  virtual Expected<size_t>
+  write_vectored(std::span<const std::span<const std::byte>> bufs);
 
   virtual ~Writer() = default;
   virtual Expected<void> write_all(std::span<const std::byte> buf);
+  // Advances the spans in place as they are written.
+  Expected<void> write_all_vectored(std::span<std::span<const std::byte>> bufs);
+  // The writer's BufWrite side, if it has one.
+  virtual BufWrite* write_buffer() { return nullptr; }
 
   template <typename... Args>
   std::expected<void, Err> write_fmt(std::format_string<Args...> fmt,
@@ -78,7 +121,7 @@ public:
 
   template <typename T>
   Expected<void> write_from(T&& src) {
-    return WriteFrom<std::remove_reference_t<T>>::write_from(*this, src);
+    return WriteFrom<std::remove_cvref_t<T>>::write_from(*this, src);
   };
 
   class OperatorWrapper {
@@ -131,6 +174,44 @@ inline Expected<void> Reader::read_exact(std::span<std::byte> buf) {
   return {};
 }
 
+inline Expected<size_t>
+Reader::read_vectored(std::span<const std::span<std::byte>> bufs) {
+  for (auto buf : bufs)
+    if (!buf.empty())
+      return read(buf);
+  return 0;
+}
+
+inline Expected<size_t>
+Writer::write_vectored(std::span<const std::span<const std::byte>> bufs) {
+  for (auto buf : bufs)
+    if (!buf.empty())
+      return write(buf);
+  return 0;
+}
+
+inline Expected<void>
+Writer::write_all_vectored(std::span<std::span<const std::byte>> bufs) {
+  while (true) {
+    while (!bufs.empty() && bufs.front().empty())
+      bufs = bufs.subspan(1);
+    if (bufs.empty())
+      return {};
+    auto res = write_vectored(bufs);
+    if (!res)
+      return Unexpected(res.error());
+    if (*res == 0)
+      return Unexpected(Err::WriteZero);
+    for (size_t n = *res; n > 0 && !bufs.empty();) {
+      size_t step = std::min(n, bufs.front().size());
+      bufs.front() = bufs.front().subspan(step);
+      n -= step;
+      if (bufs.front().empty())
+        bufs = bufs.subspan(1);
+    }
+  }
+}
+
 inline Expected<void> Writer::write_all(std::span<const std::byte> buf) {
   while (!buf.empty()) {
     auto res = write(buf);
@@ -143,10 +224,88 @@ inline Expected<void> Writer::write_all(std::span<const std::byte> buf) {
   return {};
 }
 
+// Output target for std::format_to. Characters go straight into the
+// writer's buffer, which is committed and flushed as it fills; writers
+// without one get the output in chunks from a small local array. After
+// an error the rest of the output is dropped and finish() reports it.
+class FormatSink {
+  Writer& w_;
+  BufWrite* bw_;
+  std::byte local_[256];
+  std::byte *first_ = local_, *pos_ = local_, *end_ = local_ + sizeof(local_);
+  Expected<void> status_;
+
+  Expected<void> drain_() {
+    if (bw_) {
+      bw_->commit(static_cast<size_t>(pos_ - first_));
+      first_ = pos_;
+      return {};
+    }
+    auto res = w_.write_all(std::span(first_, pos_));
+    pos_ = first_;
+    return res;
+  }
+
+  void refill_() {
+    if (status_)
+      status_ = drain_();
+    if (status_ && bw_) {
+      auto buf = bw_->reserve(1);
+      if (buf && !buf->empty()) {
+        first_ = pos_ = buf->data();
+        end_ = buf->data() + buf->size();
+        return;
+      }
+      if (!buf)
+        status_ = Unexpected(buf.error());
+      bw_ = nullptr;
+    }
+    first_ = pos_ = local_;
+    end_ = local_ + sizeof(local_);
+  }
+
+public:
+  class iterator {
+    FormatSink* sink_;
+
+  public:
+    using difference_type = std::ptrdiff_t;
+
+    explicit iterator(FormatSink& sink) : sink_(&sink) {}
+    iterator& operator=(char c) {
+      if (sink_->pos_ == sink_->end_)
+        sink_->refill_();
+      *sink_->pos_++ = static_cast<std::byte>(c);
+      return *this;
+    }
+    iterator& operator*() { return *this; }
+    iterator& operator++() { return *this; }
+    iterator operator++(int) { return *this; }
+  };
+
+  explicit FormatSink(Writer& w) : w_(w), bw_(w.write_buffer()) {
+    if (bw_) {
+      end_ = pos_;
+      refill_();
+    }
+  }
+  FormatSink(const FormatSink&) = delete;
+  FormatSink& operator=(const FormatSink&) = delete;
+
+  iterator out() { return iterator(*this); }
+  Expected<void> finish() {
+    if (status_)
+      status_ = drain_();
+    return status_;
+  }
+};
+
 template <typename... Args>
 std::expected<void, Err> Writer::write_fmt(std::format_string<Args...> fmt,
                                            Args&&... args) {
-  return write_from(std::format(fmt, std::forward<Args>(args)...));
+  FormatSink sink(*this);
+  std::format_to(sink.out(), fmt, std::forward<Args>(args)...);
+  return sink.finish();
 }
 
 template <>
@@ -155,6 +314,51 @@ inline Expected<void> ReadInto<std::byte>::read_into(Reader& r,
   return r.read_exact(std::span(&dest, 1));
 }
 
+// std::isspace in the "C" locale, without the locale lookup.
+inline bool is_space(std::byte b) {
+  auto c = static_cast<unsigned char>(b);
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Consumes whitespace up to the next token.
+inline Expected<void> skip_space(BufRead& r) {
+  while (true) {
+    auto buf = r.fill_buf();
+    if (!buf)
+      return Unexpected(buf.error());
+    if (buf->empty())
+      return Unexpected(Err::UnexpectedEof);
+    auto it = std::find_if_not(buf->begin(), buf->end(), is_space);
+    r.consume(static_cast<size_t>(it - buf->begin()));
+    if (it != buf->end())
+      return {};
+  }
+}
+
+// Passes the next whitespace-delimited token to f in one or more pieces,
+// straight from the reader's buffer. The delimiter is consumed as well.
+template <typename F>
+Expected<void> read_token(BufRead& r, F&& f) {
+  auto res = skip_space(r);
+  if (!res)
+    return res;
+  while (true) {
+    auto buf = r.fill_buf();
+    if (!buf)
+      return Unexpected(buf.error());
+    if (buf->empty())
+      return {};
+    auto it = std::find_if(buf->begin(), buf->end(), is_space);
+    size_t n = static_cast<size_t>(it - buf->begin());
+    f(buf->first(n));
+    if (it != buf->end()) {
+      r.consume(n + 1);
+      return {};
+    }
+    r.consume(n);
+  }
+}
+
 inline Expected<char> read_first_non_space_char(Reader& r) {
   std::byte b;
   char ch;
@@ -170,6 +374,10 @@ inline Expected<char> read_first_non_space_char(Reader& r) {
 template <>
 inline Expected<void> ReadInto<std::string>::read_into(Reader& r,
                                                        std::string& dest) {
+  if (auto* br = r.buffered())
+    return read_token(*br, [&dest](std::span<const std::byte> piece) {
+      dest.append(reinterpret_cast<const char*>(piece.data()), piece.size());
+    });
   return read_first_non_space_char(r).and_then(
       [&r, &dest](char ch) -> Expected<void> {
         do {
@@ -187,21 +395,71 @@ inline Expected<void> ReadInto<std::string>::read_into(Reader& r,
       });
 }
 
+// Numbers are parsed in place when the whole token is already buffered.
+// Otherwise it is gathered into a small stack buffer; only tokens longer
+// than that, such as long float literals, allocate. The whole token must
+// be a number in range, or dest is left alone and InvalidData returned.
 template <typename T>
   requires(std::integral<T> || std::floating_point<T>)
 class ReadInto<T> {
+  static constexpr size_t max_token = 128;
+
+  static Expected<void> parse(const char* first, const char* last, T& dest) {
+    T value;
+    auto [ptr, ec] = std::from_chars(first, last, value);
+    if (ec != std::errc{} || ptr != last)
+      return Unexpected(Err::InvalidData);
+    dest = value;
+    return {};
+  }
+
 public:
   static Expected<void> read_into(Reader& r, T& dest) {
-    std::string str;
-    auto res = r.read_into(str);
-    if (!res)
-      return res;
-    auto from_chars_res =
-        std::from_chars(str.c_str(), str.c_str() + str.size(), dest);
-    if (from_chars_res.ptr == str.c_str()) {
-      return Unexpected(Err::InvalidData);
+    char token[max_token];
+    size_t len = 0;
+    std::string spill;
+    auto append = [&](std::span<const std::byte> piece) {
+      if (spill.empty() && piece.size() <= max_token - len) {
+        std::memcpy(token + len, piece.data(), piece.size());
+        len += piece.size();
+        return;
+      }
+      if (spill.empty())
+        spill.assign(token, len);
+      spill.append(reinterpret_cast<const char*>(piece.data()), piece.size());
+    };
+
+    if (auto* br = r.buffered()) {
+      auto buf = br->fill_buf();
+      if (!buf)
+        return Unexpected(buf.error());
+      auto first = std::find_if_not(buf->begin(), buf->end(), is_space);
+      auto last = std::find_if(first, buf->end(), is_space);
+      if (last != buf->end()) {
+        auto res = parse(reinterpret_cast<const char*>(&*first),
+                         reinterpret_cast<const char*>(&*last), dest);
+        br->consume(static_cast<size_t>(last - buf->begin()) + 1);
+        return res;
+      }
+      auto res = read_token(*br, append);
+      if (!res)
+        return res;
+    } else {
+      auto ch = read_first_non_space_char(r);
+      if (!ch)
+        return Unexpected(ch.error());
+      for (std::byte b = static_cast<std::byte>(*ch); !is_space(b);) {
+        append(std::span(&b, 1));
+        auto res = r.read_into(b);
+        if (!res && res.error() == Err::UnexpectedEof)
+          break;
+        if (!res)
+          return res;
+      }
     }
-    return {};
+    if (!spill.empty())
+      return parse(spill.data(), spill.data() + spill.size(), dest);
+    return parse(token, token + len, dest);
   }
 };
 
@@ -220,12 +478,36 @@ public:
   };
 };
 
+// Integers and shortest round-trip floats are formatted with to_chars
+// directly into the writer's buffer when it has one.
 template <typename T>
   requires(std::integral<T> || std::floating_point<T>)
 class WriteFrom<T> {
+  static constexpr size_t max_chars = 64;
+
+  static char* format(char* first, char* last, const T& src) {
+    if constexpr (std::same_as<T, bool>)
+      return std::to_chars(first, last, static_cast<int>(src)).ptr;
+    else
+      return std::to_chars(first, last, src).ptr;
+  }
+
 public:
   static Expected<void> write_from(Writer& w, const T& src) {
-    return w.write_from(std::to_string(src));
+    if (auto* bw = w.write_buffer()) {
+      auto buf = bw->reserve(max_chars);
+      if (!buf)
+        return Unexpected(buf.error());
+      if (!buf->empty()) {
+        char* first = reinterpret_cast<char*>(buf->data());
+        bw->commit(static_cast<size_t>(
+            format(first, first + buf->size(), src) - first));
+        return {};
+      }
+    }
+    char tmp[max_chars];
+    char* last = format(tmp, tmp + max_chars, src);
+    return w.write_all(std::as_bytes(std::span(tmp, last)));
   };
 };
 
@@ -1,12 +1,13 @@
 #pragma once
 #include "io.hpp"
 #include <algorithm>
+#include <array>
 #include <cstring>
 #include <vector>
 
 namespace io {
 
-class BufReader : public Reader {
+class BufReader : public Reader, public BufRead {
   Reader& inner_;
   std::vector<std::byte> buf_;
   size_t pos_ = 0;
@@ -26,6 +27,9 @@ public:
       : inner_(inner), buf_(buf_size) {}
 
   Expected<size_t> read(std::span<std::byte> buf) override {
+    // Large reads into an empty buffer skip the extra copy.
+    if (pos_ == len_ && buf.size() >= buf_.size())
+      return inner_.read(buf);
     size_t total = 0;
     while (!buf.empty()) {
       if (pos_ == len_) {
@@ -43,9 +47,45 @@ public:
     }
     return total;
   }
+
+  Expected<size_t>
+  read_vectored(std::span<const std::span<std::byte>> bufs) override {
+    size_t total = 0;
+    for (auto& b : bufs)
+      total += b.size();
+    if (pos_ == len_ && total >= buf_.size())
+      return inner_.read_vectored(bufs);
+    auto avail = fill_buf();
+    if (!avail)
+      return Unexpected(avail.error());
+    size_t n = 0;
+    for (auto& b : bufs) {
+      size_t step = std::min(b.size(), avail->size() - n);
+      std::copy_n(avail->data() + n, step, b.data());
+      n += step;
+    }
+    consume(n);
+    return n;
+  }
+
+  Expected<std::span<const std::byte>> fill_buf() override {
+    if (pos_ == len_) {
+      auto res = fill_buf_();
+      if (!res)
+        return Unexpected(res.error());
+    }
+    return std::span<const std::byte>(buf_).subspan(pos_, len_ - pos_);
+  }
+
+  void consume(size_t n) override { pos_ = std::min(pos_ + n, len_); }
+  BufRead* buffered() override { return this; }
 };
 
-class BufWriter : public Writer {
+class BufWriter : public Writer, public BufWrite {
+  // Payloads too large to buffer go out together with the buffered bytes
+  // in one vectored write of up to this many slices.
+  static constexpr size_t max_slices = 16;
+
   Writer& inner_;
   std::vector<std::byte> buf_;
   size_t pos_ = 0;
@@ -57,22 +97,55 @@ public:
   ~BufWriter() { flush(); }
 
   Expected<size_t> write(std::span<const std::byte> buf) override {
+    return write_vectored(std::span(&buf, 1));
+  }
+
+  Expected<size_t>
+  write_vectored(std::span<const std::span<const std::byte>> bufs) override {
     size_t total = 0;
-    while (!buf.empty()) {
-      if (pos_ == buf_.size()) {
-        auto res = flush();
-        if (!res)
-          return Unexpected(res.error());
-      }
-      size_t n = std::min(buf.size(), buf_.size() - pos_);
-      std::copy_n(buf.data(), n, buf_.data() + pos_);
-      pos_ += n;
-      buf = buf.subspan(n);
-      total += n;
+    for (auto& b : bufs)
+      total += b.size();
+    if (total > buf_.size() - pos_ && total >= buf_.size() &&
+        bufs.size() < max_slices) {
+      std::array<std::span<const std::byte>, max_slices> slices;
+      slices[0] = std::span<const std::byte>(buf_.data(), pos_);
+      std::copy(bufs.begin(), bufs.end(), slices.begin() + 1);
+      auto res =
+          inner_.write_all_vectored(std::span(slices).first(bufs.size() + 1));
+      if (!res)
+        return Unexpected(res.error());
+      pos_ = 0;
+      return total;
     }
+    for (auto buf : bufs)
+      while (!buf.empty()) {
+        if (pos_ == buf_.size()) {
+          auto res = flush();
+          if (!res)
+            return Unexpected(res.error());
+        }
+        size_t n = std::min(buf.size(), buf_.size() - pos_);
+        std::copy_n(buf.data(), n, buf_.data() + pos_);
+        pos_ += n;
+        buf = buf.subspan(n);
+      }
     return total;
   }
 
+  Expected<std::span<std::byte>> reserve(size_t n) override {
+    if (n > buf_.size())
+      return std::span<std::byte>();
+    if (buf_.size() - pos_ < n) {
+      auto res = flush();
+      if (!res)
+        return Unexpected(res.error());
+    }
+    return std::span(buf_).subspan(pos_);
+  }
+
+  void commit(size_t n) override { pos_ = std::min(pos_ + n, buf_.size()); }
+  BufWrite* write_buffer() override { return this; }
+
   Expected<void> flush() override {
     if (pos_ == 0)
       return {};
@@ -82,6 +155,10 @@ public:
     pos_ = 0;
     return {};
   }
+
+protected:
+  // Drops buffered bytes, for owners whose inner writer is going away.
+  void discard_() { pos_ = 0; }
 };
 
 class BufReaderWriter : public BufReader, public BufWriter {
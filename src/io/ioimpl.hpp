@@ -2,12 +2,19 @@
 #include "iobuf.hpp"
 #include "src/io/io.hpp"
 #include <algorithm>
+#include <cerrno>
+#include <climits>
 #include <cstdio>
 #include <cstring>
+#include <fcntl.h>
 #include <string>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <utility>
 
 namespace io {
-class StringReaderWriter : public ReaderWriter {
+class StringReaderWriter : public ReaderWriter, public BufRead {
   std::string data_;
   size_t read_pos_ = 0;
   size_t write_pos_ = 0;
@@ -26,6 +33,27 @@ public:
     return n;
   }
 
+  Expected<size_t>
+  read_vectored(std::span<const std::span<std::byte>> bufs) override {
+    size_t total = 0;
+    for (auto buf : bufs) {
+      auto res = read(buf);
+      total += *res;
+      if (*res < buf.size())
+        break;
+    }
+    return total;
+  }
+
+  Expected<std::span<const std::byte>> fill_buf() override {
+    return std::as_bytes(std::span(data_)).subspan(read_pos_);
+  }
+
+  void consume(size_t n) override {
+    read_pos_ = std::min(read_pos_ + n, data_.size());
+  }
+  BufRead* buffered() override { return this; }
+
   Expected<size_t> write(std::span<const std::byte> buf) override {
     size_t n = buf.size();
     if (write_pos_ + n > data_.size())
@@ -35,6 +63,14 @@ public:
     return n;
   }
 
+  Expected<size_t>
+  write_vectored(std::span<const std::span<const std::byte>> bufs) override {
+    size_t total = 0;
+    for (auto buf : bufs)
+      total += *write(buf);
+    return total;
+  }
+
   Expected<void> flush() override { return {}; }
 };
 
@@ -79,4 +115,119 @@ public:
   FileBufReaderWriter(FILE* file) : BufReaderWriter(inner_), inner_(file) {}
 };
 
+// Reads and writes a raw file descriptor with no stdio buffering
+// underneath, so wrapping it in BufReader/BufWriter is the only copy.
+// Interrupted calls are retried.
+class FdReaderWriter : public ReaderWriter {
+  // Slices beyond this are left for the next call, as readv/writev may
+  // return short anyway.
+  static constexpr size_t max_slices = 64;
+
+  int fd_ = -1;
+  bool owned_ = false;
+
+  template <typename F>
+  static Expected<size_t> retry_(F&& f) {
+    while (true) {
+      ssize_t n = f();
+      if (n >= 0)
+        return static_cast<size_t>(n);
+      if (errno != EINTR)
+        return Unexpected(Err::InvalidData);
+    }
+  }
+
+  template <typename Span>
+  static int to_iovecs_(std::span<const Span> bufs, iovec* iov) {
+    size_t n = std::min({bufs.size(), max_slices, size_t(IOV_MAX)});
+    for (size_t i = 0; i < n; i++)
+      iov[i] = {const_cast<std::byte*>(bufs[i].data()), bufs[i].size()};
+    return static_cast<int>(n);
+  }
+
+public:
+  explicit FdReaderWriter(int fd, bool owned = false)
+      : fd_(fd), owned_(owned) {}
+
+  // Files opened for reading are advised as sequential scans.
+  static Expected<FdReaderWriter> open(const char* path, int flags,
+                                       mode_t mode = 0644) {
+    int fd;
+    do
+      fd = ::open(path, flags | O_CLOEXEC, mode);
+    while (fd < 0 && errno == EINTR);
+    if (fd < 0)
+      return Unexpected(Err::InvalidData);
+    FdReaderWriter f(fd, true);
+    if ((flags & O_ACCMODE) != O_WRONLY)
+      f.advise_sequential();
+    return f;
+  }
+
+  FdReaderWriter(const FdReaderWriter&) = delete;
+  FdReaderWriter& operator=(const FdReaderWriter&) = delete;
+  FdReaderWriter(FdReaderWriter&& other)
+      : fd_(std::exchange(other.fd_, -1)),
+        owned_(std::exchange(other.owned_, false)) {}
+  ~FdReaderWriter() {
+    if (owned_)
+      ::close(fd_);
+  }
+
+  int fd() const { return fd_; }
+
+  Expected<size_t> read(std::span<std::byte> buf) override {
+    return retry_([&] { return ::read(fd_, buf.data(), buf.size()); });
+  }
+
+  // Reads at an absolute offset without moving the file position.
+  Expected<size_t> pread(std::span<std::byte> buf, off_t offset) {
+    return retry_(
+        [&] { return ::pread(fd_, buf.data(), buf.size(), offset); });
+  }
+
+  Expected<size_t>
+  read_vectored(std::span<const std::span<std::byte>> bufs) override {
+    iovec iov[max_slices];
+    int n = to_iovecs_(bufs, iov);
+    return retry_([&] { return ::readv(fd_, iov, n); });
+  }
+
+  Expected<size_t> write(std::span<const std::byte> buf) override {
+    return retry_([&] { return ::write(fd_, buf.data(), buf.size()); });
+  }
+
+  Expected<size_t>
+  write_vectored(std::span<const std::span<const std::byte>> bufs) override {
+    iovec iov[max_slices];
+    int n = to_iovecs_(bufs, iov);
+    return retry_([&] { return ::writev(fd_, iov, n); });
+  }
+
+  Expected<void> flush() override { return {}; }
+
+  // Hints the kernel to read ahead aggressively over [offset, offset +
+  // len), or to the end of the file when len is 0.
+  Expected<void> advise_sequential(off_t offset = 0, off_t len = 0) {
+    if (::posix_fadvise(fd_, offset, len, POSIX_FADV_SEQUENTIAL) != 0)
+      return Unexpected(Err::InvalidData);
+    return {};
+  }
+};
+
+class FdBufReaderWriter : public BufReaderWriter {
+  FdReaderWriter inner_;
+
+public:
+  explicit FdBufReaderWriter(FdReaderWriter&& fd, size_t read_buf_size = 65536,
+                             size_t write_buf_size = 65536)
+      : BufReaderWriter(inner_, read_buf_size, write_buf_size),
+        inner_(std::move(fd)) {}
+  // inner_ goes away before the BufWriter base could flush into it, so
+  // whatever this flush fails to write is dropped rather than retried.
+  ~FdBufReaderWriter() {
+    BufWriter::flush();
+    discard_();
+  }
+};
 } // namespace io
@@ -0,0 +1,271 @@
+#pragma once
+#include "../plane.hpp"
+#include "binary.hpp"
+#include "io.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <span>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+// Binary arrays of plane types: a 4-byte magic, the uint32 element size,
+// the uint64 element count, then the elements as raw doubles in their
+// in-memory (AoS) layout. Everything is little-endian and the 16-byte
+// header keeps the payload 8-byte aligned for memory mapping.
+namespace io {
+static_assert(std::endian::native == std::endian::little,
+              "binary plane format is only implemented for little-endian hosts");
+
+template <typename T>
+struct BinaryArrayTag;
+
+template <>
+struct BinaryArrayTag<plane::Point> {
+  static constexpr std::array<char, 4> magic{'P', 'T', '2', 'D'};
+};
+
+template <>
+struct BinaryArrayTag<plane::Segment> {
+  static constexpr std::array<char, 4> magic{'S', 'G', '2', 'D'};
+};
+
+struct BinaryArrayHeader {
+  std::array<char, 4> magic;
+  uint32_t element_size;
+  uint64_t count;
+};
+static_assert(sizeof(BinaryArrayHeader) == 16);
+
+template <typename T>
+concept BinaryArrayElement =
+    std::is_trivially_copyable_v<T> && requires { BinaryArrayTag<T>::magic; };
+
+static_assert(sizeof(plane::Point) == 2 * sizeof(double));
+static_assert(sizeof(plane::Segment) == 4 * sizeof(double));
+
+template <BinaryArrayElement T>
+class ArrayChunkReader {
+  Reader* r_;
+  uint64_t remaining_;
+
+  ArrayChunkReader(Reader& r, uint64_t count) : r_(&r), remaining_(count) {}
+
+public:
+  static Expected<ArrayChunkReader> open(Reader& r) {
+    BinaryArrayHeader header;
+    auto res = r.read_exact(std::as_writable_bytes(std::span(&header, 1)));
+    if (!res)
+      return Unexpected(res.error());
+    if (header.magic != BinaryArrayTag<T>::magic ||
+        header.element_size != sizeof(T))
+      return Unexpected(Err::InvalidData);
+    return ArrayChunkReader(r, header.count);
+  }
+
+  uint64_t remaining() const { return remaining_; }
+
+  Expected<size_t> read(std::span<T> buf) {
+    size_t n = static_cast<size_t>(std::min<uint64_t>(buf.size(), remaining_));
+    auto res = r_->read_exact(std::as_writable_bytes(buf.first(n)));
+    if (!res)
+      return Unexpected(res.error());
+    remaining_ -= n;
+    return n;
+  }
+};
+
+template <BinaryArrayElement T>
+class ArrayChunkWriter {
+  Writer* w_;
+  uint64_t remaining_;
+
+  ArrayChunkWriter(Writer& w, uint64_t count) : w_(&w), remaining_(count) {}
+
+public:
+  static Expected<ArrayChunkWriter> open(Writer& w, uint64_t count) {
+    BinaryArrayHeader header{BinaryArrayTag<T>::magic, sizeof(T), count};
+    auto res = w.write_all(std::as_bytes(std::span(&header, 1)));
+    if (!res)
+      return Unexpected(res.error());
+    return ArrayChunkWriter(w, count);
+  }
+
+  uint64_t remaining() const { return remaining_; }
+
+  // Items count as written only once they reach the writer.
+  Expected<void> write(std::span<const T> items) {
+    if (items.size() > remaining_)
+      return Unexpected(Err::InvalidData);
+    auto res = w_->write_all(std::as_bytes(items));
+    if (res)
+      remaining_ -= items.size();
+    return res;
+  }
+
+  // Fails unless exactly the count given to open was written.
+  Expected<void> finish() const {
+    if (remaining_ != 0)
+      return Unexpected(Err::InvalidData);
+    return {};
+  }
+};
+
+template <BinaryArrayElement T>
+class ReadInto<std::vector<T>> {
+public:
+  static Expected<void> read_into(Reader& r, std::vector<T>& dest) {
+    return ArrayChunkReader<T>::open(r).and_then(
+        [&dest](ArrayChunkReader<T> reader) -> Expected<void> {
+          // The count is untrusted; grow as the elements arrive.
+          size_t step_items =
+              std::max<size_t>(1, detail::binary_read_step / sizeof(T));
+          dest.clear();
+          while (reader.remaining() > 0) {
+            size_t done = dest.size();
+            size_t step = static_cast<size_t>(
+                std::min<uint64_t>(reader.remaining(), step_items));
+            dest.resize(done + step);
+            auto res = reader.read(std::span(dest).subspan(done));
+            if (!res)
+              return Unexpected(res.error());
+          }
+          return {};
+        });
+  }
+};
+
+template <BinaryArrayElement T>
+class WriteFrom<std::vector<T>> {
+public:
+  static Expected<void> write_from(Writer& w, const std::vector<T>& src) {
+    return ArrayChunkWriter<T>::open(w, src.size())
+        .and_then([&src](ArrayChunkWriter<T> writer) -> Expected<void> {
+          auto res = writer.write(src);
+          if (!res)
+            return res;
+          return writer.finish();
+        });
+  }
+};
+
+struct PointsSoA {
+  std::vector<double> x, y;
+};
+
+template <>
+class ReadInto<PointsSoA> {
+public:
+  static Expected<void> read_into(Reader& r, PointsSoA& dest) {
+    auto reader = ArrayChunkReader<plane::Point>::open(r);
+    if (!reader)
+      return Unexpected(reader.error());
+    dest.x.clear();
+    dest.y.clear();
+    std::array<plane::Point, 1024> chunk;
+    while (reader->remaining() > 0) {
+      auto res = reader->read(chunk);
+      if (!res)
+        return Unexpected(res.error());
+      size_t done = dest.x.size();
+      dest.x.resize(done + *res);
+      dest.y.resize(done + *res);
+      for (size_t i = 0; i < *res; i++) {
+        dest.x[done + i] = chunk[i].x;
+        dest.y[done + i] = chunk[i].y;
+      }
+    }
+    return {};
+  }
+};
+
+template <>
+class WriteFrom<PointsSoA> {
+public:
+  static Expected<void> write_from(Writer& w, const PointsSoA& src) {
+    if (src.x.size() != src.y.size())
+      return Unexpected(Err::InvalidData);
+    auto writer = ArrayChunkWriter<plane::Point>::open(w, src.x.size());
+    if (!writer)
+      return Unexpected(writer.error());
+    std::array<plane::Point, 1024> chunk;
+    for (size_t done = 0; done < src.x.size();) {
+      size_t n = std::min(chunk.size(), src.x.size() - done);
+      for (size_t i = 0; i < n; i++)
+        chunk[i] = plane::Point{src.x[done + i], src.y[done + i]};
+      auto res = writer->write(std::span(chunk).first(n));
+      if (!res)
+        return res;
+      done += n;
+    }
+    return writer->finish();
+  }
+};
+
+// Read-only memory map of a binary array file; the elements are used in
+// place without copying.
+template <BinaryArrayElement T>
+class MappedArray {
+  void* addr_ = nullptr;
+  size_t length_ = 0;
+  std::span<const T> items_;
+
+  MappedArray(void* addr, size_t length, std::span<const T> items)
+      : addr_(addr), length_(length), items_(items) {}
+
+public:
+  static Expected<MappedArray> open(const char* path) {
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+      return Unexpected(Err::InvalidData);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      return Unexpected(Err::InvalidData);
+    }
+    size_t length = static_cast<size_t>(st.st_size);
+    if (length < sizeof(BinaryArrayHeader)) {
+      ::close(fd);
+      return Unexpected(Err::UnexpectedEof);
+    }
+    void* addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+      return Unexpected(Err::InvalidData);
+    MappedArray mapped(addr, length, {});
+
+    BinaryArrayHeader header;
+    std::memcpy(&header, addr, sizeof(header));
+    if (header.magic != BinaryArrayTag<T>::magic ||
+        header.element_size != sizeof(T))
+      return Unexpected(Err::InvalidData);
+    if (header.count > (length - sizeof(header)) / sizeof(T))
+      return Unexpected(Err::UnexpectedEof);
+    ::madvise(addr, length, MADV_SEQUENTIAL);
+    mapped.items_ = std::span(
+        reinterpret_cast<const T*>(static_cast<const char*>(addr) + sizeof(header)),
+        static_cast<size_t>(header.count));
+    return mapped;
+  }
+
+  MappedArray(const MappedArray&) = delete;
+  MappedArray& operator=(const MappedArray&) = delete;
+  MappedArray(MappedArray&& other)
+      : addr_(std::exchange(other.addr_, nullptr)),
+        length_(std::exchange(other.length_, 0)),
+        items_(std::exchange(other.items_, {})) {}
+  ~MappedArray() {
+    if (addr_)
+      ::munmap(addr_, length_);
+  }
+
+  std::span<const T> items() const { return items_; }
+};
+} // namespace io
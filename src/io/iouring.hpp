@@ -0,0 +1,456 @@
+#pragma once
+#include "io.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <memory>
+#include <span>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+// File streams that keep several chunk-sized reads or writes in flight
+// through io_uring, talking to the kernel directly rather than through
+// liburing. When a ring cannot be set up (old kernel, seccomp, disabled
+// by sysctl) the same streams run on blocking pread/pwrite.
+namespace io {
+struct UringOptions {
+  size_t chunk_size = 1 << 20;
+  unsigned depth = 8;
+  bool use_uring = true;
+};
+
+namespace detail {
+class Ring {
+  int fd_ = -1;
+  void* sq_ptr_ = MAP_FAILED;
+  void* cq_ptr_ = MAP_FAILED;
+  size_t sq_len_ = 0, cq_len_ = 0, sqes_len_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  io_uring_cqe* cqes_ = nullptr;
+  unsigned *sq_tail_ = nullptr, *sq_mask_ = nullptr, *sq_array_ = nullptr;
+  unsigned *cq_head_ = nullptr, *cq_tail_ = nullptr, *cq_mask_ = nullptr;
+  unsigned to_submit_ = 0;
+  bool fixed_ = false;
+
+  Ring() = default;
+
+public:
+  static std::unique_ptr<Ring> create(unsigned entries) {
+    io_uring_params p{};
+    int fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+    if (fd < 0)
+      return nullptr;
+    std::unique_ptr<Ring> r(new Ring);
+    r->fd_ = fd;
+    r->sq_len_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_len_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single)
+      r->sq_len_ = r->cq_len_ = std::max(r->sq_len_, r->cq_len_);
+    r->sq_ptr_ = ::mmap(nullptr, r->sq_len_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (r->sq_ptr_ == MAP_FAILED)
+      return nullptr;
+    r->cq_ptr_ = single ? r->sq_ptr_
+                        : ::mmap(nullptr, r->cq_len_, PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_POPULATE, fd,
+                                 IORING_OFF_CQ_RING);
+    if (r->cq_ptr_ == MAP_FAILED)
+      return nullptr;
+    r->sqes_len_ = p.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(nullptr, r->sqes_len_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+      return nullptr;
+    r->sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    auto sq = static_cast<char*>(r->sq_ptr_);
+    auto cq = static_cast<char*>(r->cq_ptr_);
+    r->sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    r->sq_mask_ = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    r->sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    r->cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    r->cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    r->cq_mask_ = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    r->cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+    return r;
+  }
+
+  Ring(const Ring&) = delete;
+  Ring& operator=(const Ring&) = delete;
+  ~Ring() {
+    if (sqes_)
+      ::munmap(sqes_, sqes_len_);
+    if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_)
+      ::munmap(cq_ptr_, cq_len_);
+    if (sq_ptr_ != MAP_FAILED)
+      ::munmap(sq_ptr_, sq_len_);
+    ::close(fd_);
+  }
+
+  // Pins the buffers so requests can use the *_FIXED opcodes; fails
+  // quietly when the memlock limit is too low.
+  void register_buffers(std::span<const iovec> bufs) {
+    fixed_ = ::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS,
+                       bufs.data(), static_cast<unsigned>(bufs.size())) == 0;
+  }
+
+  // The caller never has more requests outstanding than ring entries.
+  void prepare(bool write, int fd, std::byte* data, size_t len, uint64_t offset,
+               uint16_t buf_index) {
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & *sq_mask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    if (fixed_) {
+      sqe->opcode = write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+      sqe->buf_index = buf_index;
+    } else {
+      sqe->opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+    }
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(data);
+    sqe->len = static_cast<uint32_t>(len);
+    sqe->off = offset;
+    sqe->user_data = buf_index;
+    sq_array_[index] = index;
+    std::atomic_ref<unsigned>(*sq_tail_).store(tail + 1,
+                                               std::memory_order_release);
+    to_submit_++;
+  }
+
+  // Withdraws the last prepared request. Only valid after enter failed,
+  // since the kernel then consumed none of the queue.
+  void unprepare() {
+    std::atomic_ref<unsigned>(*sq_tail_).store(*sq_tail_ - 1,
+                                               std::memory_order_release);
+    to_submit_--;
+  }
+
+  // Submits everything prepared and blocks for at least wait_nr
+  // completions.
+  bool enter(unsigned wait_nr) {
+    while (to_submit_ > 0 || wait_nr > 0) {
+      long n = ::syscall(__NR_io_uring_enter, fd_, to_submit_, wait_nr,
+                         wait_nr ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n < 0)
+        return false;
+      to_submit_ -= static_cast<unsigned>(n);
+      return true;
+    }
+    return true;
+  }
+
+  bool pop(uint64_t& user_data, int& res) {
+    unsigned head = *cq_head_;
+    if (head ==
+        std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire))
+      return false;
+    const io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+    user_data = cqe.user_data;
+    res = cqe.res;
+    std::atomic_ref<unsigned>(*cq_head_).store(head + 1,
+                                               std::memory_order_release);
+    return true;
+  }
+};
+
+// A file plus depth chunk buffers, each either idle or owned by one
+// outstanding request.
+class UringFile {
+  struct Free {
+    void operator()(std::byte* p) const { std::free(p); }
+  };
+
+public:
+  struct Chunk {
+    std::byte* data;
+    uint64_t offset;
+    size_t len;
+    ssize_t result;
+    bool busy;
+  };
+
+  int fd = -1;
+  size_t chunk_size = 0;
+  std::vector<Chunk> chunks;
+
+private:
+  std::unique_ptr<Ring> ring_;
+  std::unique_ptr<std::byte, Free> memory_;
+
+  void complete_(uint64_t i, int res) {
+    chunks[i].result = res;
+    chunks[i].busy = false;
+  }
+
+public:
+  static Expected<UringFile> open(const char* path, int flags,
+                                  const UringOptions& opts) {
+    UringFile f;
+    do
+      f.fd = ::open(path, flags | O_CLOEXEC, 0644);
+    while (f.fd < 0 && errno == EINTR);
+    if (f.fd < 0)
+      return Unexpected(Err::InvalidData);
+    unsigned depth = std::clamp(opts.depth, 1u, 1024u);
+    f.chunk_size = std::max<size_t>(opts.chunk_size, 4096) & ~size_t(4095);
+    f.memory_.reset(static_cast<std::byte*>(
+        std::aligned_alloc(4096, f.chunk_size * depth)));
+    if (!f.memory_)
+      return Unexpected(Err::InvalidData);
+    std::vector<iovec> iov(depth);
+    for (unsigned i = 0; i < depth; i++) {
+      f.chunks.push_back(
+          {f.memory_.get() + i * f.chunk_size, 0, 0, 0, false});
+      iov[i] = {f.chunks[i].data, f.chunk_size};
+    }
+    if (opts.use_uring && (f.ring_ = Ring::create(depth)))
+      f.ring_->register_buffers(iov);
+    return f;
+  }
+
+  UringFile() = default;
+  UringFile(UringFile&& o)
+      : fd(std::exchange(o.fd, -1)), chunk_size(o.chunk_size),
+        chunks(std::move(o.chunks)), ring_(std::move(o.ring_)),
+        memory_(std::move(o.memory_)) {}
+  ~UringFile() {
+    drain();
+    if (fd >= 0)
+      ::close(fd);
+  }
+
+  bool async() const { return ring_ != nullptr; }
+
+  // Starts a read or write of chunk i; without a ring it completes
+  // before returning.
+  void submit(size_t i, bool write, uint64_t offset, size_t len) {
+    Chunk& c = chunks[i];
+    c.offset = offset, c.len = len, c.busy = true;
+    if (ring_) {
+      ring_->prepare(write, fd, c.data, len, offset, static_cast<uint16_t>(i));
+      if (ring_->enter(0))
+        return;
+      ring_->unprepare();
+      complete_(i, -EIO);
+      return;
+    }
+    ssize_t n;
+    do
+      n = write ? ::pwrite(fd, c.data, len, static_cast<off_t>(offset))
+                : ::pread(fd, c.data, len, static_cast<off_t>(offset));
+    while (n < 0 && errno == EINTR);
+    complete_(i, n < 0 ? -errno : static_cast<int>(n));
+  }
+
+  void wait(size_t i) {
+    while (chunks[i].busy) {
+      uint64_t id;
+      int res;
+      if (!ring_->enter(1)) {
+        complete_(i, -EIO);
+        return;
+      }
+      while (ring_->pop(id, res))
+        complete_(id, res);
+    }
+  }
+
+  void drain() {
+    for (size_t i = 0; i < chunks.size(); i++)
+      wait(i);
+  }
+};
+} // namespace detail
+
+// Sequential reader with depth chunks of read-ahead. Chunks are handed out
+// in place through BufRead, so parsers see the bytes the kernel wrote.
+class UringReader : public Reader, public BufRead {
+  detail::UringFile file_;
+  size_t cur_ = 0, pos_ = 0;
+  uint64_t next_offset_ = 0;
+  bool eof_ = false;
+
+  explicit UringReader(detail::UringFile&& file) : file_(std::move(file)) {
+    restart_(0);
+  }
+
+  void read_ahead_(size_t i) {
+    file_.submit(i, false, next_offset_, file_.chunk_size);
+    next_offset_ += file_.chunk_size;
+  }
+
+  // Discards the read-ahead and starts again from offset.
+  void restart_(uint64_t offset) {
+    file_.drain();
+    next_offset_ = offset;
+    pos_ = 0;
+    for (size_t k = 0; k < file_.chunks.size(); k++)
+      read_ahead_((cur_ + k) % file_.chunks.size());
+  }
+
+public:
+  static Expected<UringReader> open(const char* path,
+                                    const UringOptions& opts = {}) {
+    auto file = detail::UringFile::open(path, O_RDONLY, opts);
+    if (!file)
+      return Unexpected(file.error());
+    ::posix_fadvise(file->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    return UringReader(std::move(*file));
+  }
+
+  UringReader(UringReader&&) = default;
+
+  bool async() const { return file_.async(); }
+  BufRead* buffered() override { return this; }
+
+  Expected<std::span<const std::byte>> fill_buf() override {
+    while (!eof_) {
+      auto& c = file_.chunks[cur_];
+      file_.wait(cur_);
+      if (c.result == -EAGAIN || c.result == -EINTR) {
+        file_.submit(cur_, false, c.offset, c.len);
+        continue;
+      }
+      if (c.result < 0)
+        return Unexpected(Err::InvalidData);
+      size_t got = static_cast<size_t>(c.result);
+      if (pos_ < got)
+        return std::span<const std::byte>(c.data + pos_, got - pos_);
+      if (got == 0) {
+        eof_ = true;
+      } else if (got < c.len) {
+        // Short read: at the end of the file this finds the 0-byte read
+        // on the next pass; anywhere else it closes the gap.
+        restart_(c.offset + got);
+      } else {
+        read_ahead_(cur_);
+        cur_ = (cur_ + 1) % file_.chunks.size();
+        pos_ = 0;
+      }
+    }
+    return std::span<const std::byte>();
+  }
+
+  void consume(size_t n) override { pos_ += n; }
+
+  Expected<size_t> read(std::span<std::byte> buf) override {
+    auto avail = fill_buf();
+    if (!avail)
+      return Unexpected(avail.error());
+    size_t n = std::min(buf.size(), avail->size());
+    std::copy_n(avail->data(), n, buf.data());
+    consume(n);
+    return n;
+  }
+};
+
+// Sequential writer filling one chunk while up to depth - 1 earlier ones
+// are being written. Errors surface on a later write or flush().
+class UringWriter : public Writer, public BufWrite {
+  detail::UringFile file_;
+  size_t cur_ = 0, pos_ = 0;
+  uint64_t offset_ = 0;
+  Expected<void> status_;
+
+  explicit UringWriter(detail::UringFile&& file) : file_(std::move(file)) {}
+
+  // Collects the outcome of chunk i, finishing a short write in place.
+  void settle_(size_t i) {
+    auto& c = file_.chunks[i];
+    file_.wait(i);
+    size_t done = c.result > 0 ? static_cast<size_t>(c.result) : 0;
+    while (c.result >= 0 && done < c.len) {
+      ssize_t n = ::pwrite(file_.fd, c.data + done, c.len - done,
+                           static_cast<off_t>(c.offset + done));
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0) {
+        c.result = n < 0 ? -errno : -EIO;
+        break;
+      }
+      done += static_cast<size_t>(n);
+    }
+    if (status_ && c.result < 0)
+      status_ = Unexpected(Err::InvalidData);
+    c.len = 0;
+  }
+
+  void submit_current_() {
+    file_.submit(cur_, true, offset_, pos_);
+    offset_ += pos_;
+    cur_ = (cur_ + 1) % file_.chunks.size();
+    pos_ = 0;
+    settle_(cur_);
+  }
+
+public:
+  static Expected<UringWriter> open(const char* path,
+                                    const UringOptions& opts = {}) {
+    auto file =
+        detail::UringFile::open(path, O_WRONLY | O_CREAT | O_TRUNC, opts);
+    if (!file)
+      return Unexpected(file.error());
+    return UringWriter(std::move(*file));
+  }
+
+  UringWriter(UringWriter&&) = default;
+  ~UringWriter() {
+    if (!file_.chunks.empty())
+      flush();
+  }
+
+  bool async() const { return file_.async(); }
+  BufWrite* write_buffer() override { return this; }
+
+  Expected<size_t> write(std::span<const std::byte> buf) override {
+    if (!status_)
+      return Unexpected(status_.error());
+    size_t total = buf.size();
+    while (!buf.empty()) {
+      if (pos_ == file_.chunk_size)
+        submit_current_();
+      size_t n = std::min(buf.size(), file_.chunk_size - pos_);
+      std::copy_n(buf.data(), n, file_.chunks[cur_].data + pos_);
+      pos_ += n;
+      buf = buf.subspan(n);
+    }
+    return total;
+  }
+
+  Expected<std::span<std::byte>> reserve(size_t n) override {
+    if (!status_)
+      return Unexpected(status_.error());
+    if (n > file_.chunk_size)
+      return std::span<std::byte>();
+    if (file_.chunk_size - pos_ < n)
+      submit_current_();
+    return std::span(file_.chunks[cur_].data + pos_, file_.chunk_size - pos_);
+  }
+
+  void commit(size_t n) override {
+    pos_ = std::min(pos_ + n, file_.chunk_size);
+  }
+
+  // Waits until everything written so far has reached the kernel.
+  Expected<void> flush() override {
+    if (pos_ > 0)
+      submit_current_();
+    for (size_t i = 0; i < file_.chunks.size(); i++)
+      settle_(i);
+    return status_;
+  }
+};
+} // namespace io
@@ -0,0 +1,35 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace lib {
+inline unsigned hardware_threads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+template <typename F>
+void parallel_for(size_t n, F&& f, unsigned threads = 0) {
+  if (threads == 0)
+    threads = hardware_threads();
+  threads = static_cast<unsigned>(std::min<size_t>(threads, n));
+  if (threads <= 1) {
+    if (n > 0)
+      f(size_t(0), n);
+    return;
+  }
+
+  std::vector<std::jthread> workers;
+  workers.reserve(threads - 1);
+  size_t chunk = n / threads, extra = n % threads, begin = 0;
+  for (unsigned t = 0; t < threads; t++) {
+    size_t end = begin + chunk + (t < extra ? 1 : 0);
+    if (t + 1 == threads)
+      f(begin, end);
+    else
+      workers.emplace_back([&f, begin, end] { f(begin, end); });
+    begin = end;
+  }
+}
+} // namespace lib
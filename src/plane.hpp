@@ -1,62 +1,197 @@
 #pragma once
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <concepts>
+#include <limits>
 #include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
 
 namespace plane {
-bool partial_eq(double a, double b) { return std::abs(a - b) < 1e-9; }
+template <typename S>
+struct Tolerance;
 
-struct Vector {
-  double x, y;
+template <std::floating_point S>
+struct Tolerance<S> {
+  static constexpr S epsilon = std::is_same_v<S, float> ? S(1e-5) : S(1e-9);
+  static constexpr bool eq(S a, S b) {
+    return (a < b ? b - a : a - b) < epsilon;
+  }
+};
+
+template <std::integral S>
+struct Tolerance<S> {
+  static constexpr bool eq(S a, S b) { return a == b; }
+};
+
+template <typename S>
+constexpr bool partial_eq(S a, std::type_identity_t<S> b) {
+  return Tolerance<S>::eq(a, b);
+}
 
-  static Vector zero() { return {0, 0}; };
-  bool operator==(const Vector& v) const {
+template <typename S>
+using RealFor = std::conditional_t<std::floating_point<S>, S, double>;
+
+template <typename S>
+struct BasicVector {
+  S x, y;
+
+  static constexpr BasicVector zero() { return {0, 0}; };
+  constexpr bool operator==(const BasicVector& v) const {
     return partial_eq(x, v.x) && partial_eq(y, v.y);
   }
-  Vector operator+(const Vector& v) const { return {x + v.x, y + v.y}; }
-  Vector operator-(const Vector& v) const { return {x - v.x, y - v.y}; }
-  double operator*(const Vector& v) const { return x * v.x + y * v.y; }
-  Vector ortogonal() const { return Vector(y, -x); }
-  bool isOrtogonal(const Vector& v) const { return partial_eq(*this * v, 0); }
-  bool isCollinear(const Vector& v) const {
+  constexpr BasicVector operator+(const BasicVector& v) const {
+    return {x + v.x, y + v.y};
+  }
+  constexpr BasicVector operator-(const BasicVector& v) const {
+    return {x - v.x, y - v.y};
+  }
+  constexpr S operator*(const BasicVector& v) const {
+    return x * v.x + y * v.y;
+  }
+  constexpr S cross(const BasicVector& v) const { return x * v.y - y * v.x; }
+  constexpr BasicVector ortogonal() const { return {y, -x}; }
+  constexpr bool isOrtogonal(const BasicVector& v) const {
+    return partial_eq(*this * v, S(0));
+  }
+  constexpr bool isCollinear(const BasicVector& v) const {
     return partial_eq(x * v.y, y * v.x);
   }
 };
 
-struct Point : Vector {
-  double operator*(const Vector& v) = delete;
-  Vector ortogonal() = delete;
-  bool isOrtogonal(const Vector& v) = delete;
-  bool isCollinear(const Vector& v) = delete;
+template <typename S>
+struct BasicPoint : BasicVector<S> {
+  S operator*(const BasicVector<S>& v) = delete;
+  S cross(const BasicVector<S>& v) = delete;
+  BasicVector<S> ortogonal() = delete;
+  bool isOrtogonal(const BasicVector<S>& v) = delete;
+  bool isCollinear(const BasicVector<S>& v) = delete;
 };
 
-struct Line {
-  Point start;
-  Vector direction;
+template <typename S>
+struct BasicLine {
+  using Real = RealFor<S>;
+
+  BasicPoint<S> start;
+  BasicVector<S> direction;
 
-  Line(const Point& a, const Point& b) : start(a), direction(b - a) {
-    assert(direction != Vector::zero());
+  constexpr BasicLine(const BasicPoint<S>& a, const BasicPoint<S>& b)
+      : start(a), direction(b - a) {
+    assert(direction != BasicVector<S>::zero());
   }
-  Line(const Point& start, const Vector& direction)
+  constexpr BasicLine(const BasicPoint<S>& start,
+                      const BasicVector<S>& direction)
       : start(start), direction(direction) {};
 
-  std::optional<Point> intersection(const Line& other) const {
-    if (direction.isCollinear(other.direction)) 
+  constexpr std::optional<BasicPoint<Real>>
+  intersection(const BasicLine& other) const {
+    if (direction.isCollinear(other.direction))
       return std::nullopt;
 
-    double x1 = start.x, y1 = start.y, dx1 = direction.x, dy1 = direction.y,
-           x2 = other.start.x, y2 = other.start.y, dx2 = other.direction.x,
-           dy2 = other.direction.y;
-    double det = dx1 * dy2 - dy1 * dx2;
-    if (partial_eq(det, 0)) 
+    Real x1 = start.x, y1 = start.y, dx1 = direction.x, dy1 = direction.y,
+         x2 = other.start.x, y2 = other.start.y, dx2 = other.direction.x,
+         dy2 = other.direction.y;
+    Real det = dx1 * dy2 - dy1 * dx2;
+    if (partial_eq(det, Real(0)))
       return std::nullopt;
 
-    double t = ((x2 - x1) * dy2 - (y2 - y1) * dx2) / det;
-    return std::optional<Point>({x1 + dx1 * t, y1 + dy1 * t});
+    Real t = ((x2 - x1) * dy2 - (y2 - y1) * dx2) / det;
+    return std::optional<BasicPoint<Real>>({x1 + dx1 * t, y1 + dy1 * t});
   }
-  Line perpendicular(const Point& point) const {
-    return Line(point, direction.ortogonal());
+  constexpr BasicLine perpendicular(const BasicPoint<S>& point) const {
+    return BasicLine(point, direction.ortogonal());
   }
 };
 
+// a * x + b * y = c with (a, b) a unit normal pointing to the left of the
+// source line's direction, so value() is a signed distance.
+template <typename S>
+struct BasicImplicitLine {
+  using Real = RealFor<S>;
+
+  Real a, b, c;
+
+  constexpr BasicImplicitLine(Real a, Real b, Real c) : a(a), b(b), c(c) {}
+  explicit BasicImplicitLine(const BasicLine<S>& line) {
+    Real dx = line.direction.x, dy = line.direction.y;
+    Real len = std::sqrt(dx * dx + dy * dy);
+    a = -dy / len, b = dx / len;
+    c = a * line.start.x + b * line.start.y;
+  }
+
+  constexpr BasicVector<Real> direction() const { return {b, -a}; }
+  BasicLine<Real> line() const {
+    return BasicLine<Real>(BasicPoint<Real>{a * c, b * c}, direction());
+  }
+  constexpr Real value(const BasicPoint<S>& p) const {
+    return a * p.x + b * p.y - c;
+  }
+  constexpr bool isParallel(const BasicImplicitLine& o) const {
+    return partial_eq(a * o.b - b * o.a, Real(0));
+  }
+
+  constexpr std::optional<BasicPoint<Real>>
+  intersection(const BasicImplicitLine& o) const {
+    Real det = a * o.b - b * o.a;
+    if (partial_eq(det, Real(0)))
+      return std::nullopt;
+    return BasicPoint<Real>{(c * o.b - b * o.c) / det,
+                            (a * o.c - c * o.a) / det};
+  }
+  constexpr BasicImplicitLine perpendicular(const BasicPoint<S>& p) const {
+    return {b, -a, b * p.x - a * p.y};
+  }
+
+  // Parallel lines produce NaN coordinates.
+  void intersection(std::span<const BasicImplicitLine> others,
+                    std::span<BasicPoint<Real>> out) const {
+    if (others.size() != out.size())
+      throw std::invalid_argument("input and output sizes differ");
+    const Real a = this->a, b = this->b, c = this->c;
+    const Real nan = std::numeric_limits<Real>::quiet_NaN();
+    for (size_t i = 0; i < out.size(); i++) {
+      Real det = a * others[i].b - b * others[i].a;
+      Real inv = (det < 0 ? -det : det) < Tolerance<Real>::epsilon ? nan
+                                                                   : 1 / det;
+      out[i].x = (c * others[i].b - b * others[i].c) * inv;
+      out[i].y = (a * others[i].c - c * others[i].a) * inv;
+    }
+  }
+  void value(std::span<const BasicPoint<S>> points, std::span<Real> out) const {
+    if (points.size() != out.size())
+      throw std::invalid_argument("input and output sizes differ");
+    const Real a = this->a, b = this->b, c = this->c;
+    for (size_t i = 0; i < out.size(); i++)
+      out[i] = a * points[i].x + b * points[i].y - c;
+  }
+};
+
+template <typename S>
+struct BasicSegment {
+  using Real = RealFor<S>;
+
+  BasicPoint<S> a, b;
+
+  constexpr bool operator==(const BasicSegment& s) const {
+    return a == s.a && b == s.b;
+  }
+  constexpr BasicLine<S> line() const { return BasicLine<S>(a, b); }
+  constexpr Real distance2(const BasicPoint<S>& p) const {
+    Real dx = b.x - a.x, dy = b.y - a.y, px = p.x - a.x, py = p.y - a.y;
+    Real len2 = dx * dx + dy * dy;
+    Real t = len2 > 0 ? std::clamp((px * dx + py * dy) / len2, Real(0), Real(1))
+                      : Real(0);
+    Real ex = px - t * dx, ey = py - t * dy;
+    return ex * ex + ey * ey;
+  }
+};
+
+using Vector = BasicVector<double>;
+using Point = BasicPoint<double>;
+using Line = BasicLine<double>;
+using Segment = BasicSegment<double>;
+using ImplicitLine = BasicImplicitLine<double>;
+
 } // namespace plane
@@ -0,0 +1,143 @@
+#pragma once
+#include "plane.hpp"
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Exact signs of the orientation and incircle determinants. Each is
+// evaluated in floating point first and accepted when it clears the
+// error bound of that evaluation; otherwise it is recomputed exactly as
+// an expansion, a sum of non-overlapping doubles (Shewchuk's adaptive
+// predicates). Near-degenerate input then gives consistent answers.
+namespace plane {
+namespace detail {
+class Expansion {
+  // Increasing magnitude, no zeros; the last term carries the sign.
+  std::vector<double> terms_;
+
+public:
+  Expansion() = default;
+  explicit Expansion(double x) {
+    if (x != 0)
+      terms_.push_back(x);
+  }
+
+  static Expansion difference(double a, double b) {
+    Expansion e(a);
+    e += -b;
+    return e;
+  }
+
+  Expansion& operator+=(double x) {
+    size_t m = 0;
+    for (double t : terms_) {
+      double sum = x + t, bv = sum - x;
+      double err = (x - (sum - bv)) + (t - bv);
+      x = sum;
+      if (err != 0)
+        terms_[m++] = err;
+    }
+    terms_.resize(m);
+    if (x != 0)
+      terms_.push_back(x);
+    return *this;
+  }
+  Expansion& operator+=(const Expansion& e) {
+    for (double t : e.terms_)
+      *this += t;
+    return *this;
+  }
+  Expansion& operator-=(const Expansion& e) {
+    for (double t : e.terms_)
+      *this += -t;
+    return *this;
+  }
+
+  friend Expansion operator*(const Expansion& a, const Expansion& b) {
+    Expansion product;
+    for (double x : a.terms_)
+      for (double y : b.terms_) {
+        double xy = x * y;
+        product += std::fma(x, y, -xy);
+        product += xy;
+      }
+    return product;
+  }
+
+  int sign() const {
+    return terms_.empty() ? 0 : terms_.back() > 0 ? 1 : -1;
+  }
+};
+
+// The slow paths stay out of line so the filters inline cheaply.
+__attribute__((noinline)) inline int
+orient2d_exact(const Point& a, const Point& b, const Point& c) {
+  auto abx = Expansion::difference(b.x, a.x),
+       aby = Expansion::difference(b.y, a.y),
+       acx = Expansion::difference(c.x, a.x),
+       acy = Expansion::difference(c.y, a.y);
+  auto exact = abx * acy;
+  exact -= aby * acx;
+  return exact.sign();
+}
+
+__attribute__((noinline)) inline int
+incircle_exact(const Point& a, const Point& b, const Point& c, const Point& d) {
+  auto ex = Expansion::difference(a.x, d.x),
+       ey = Expansion::difference(a.y, d.y),
+       fx = Expansion::difference(b.x, d.x),
+       fy = Expansion::difference(b.y, d.y),
+       gx = Expansion::difference(c.x, d.x),
+       gy = Expansion::difference(c.y, d.y);
+  auto lift = [](const Expansion& x, const Expansion& y) {
+    auto l = x * x;
+    l += y * y;
+    return l;
+  };
+  auto cross = [](const Expansion& x1, const Expansion& y1,
+                  const Expansion& x2, const Expansion& y2) {
+    auto c = x1 * y2;
+    c -= x2 * y1;
+    return c;
+  };
+  auto exact = lift(ex, ey) * cross(fx, fy, gx, gy);
+  exact += lift(fx, fy) * cross(gx, gy, ex, ey);
+  exact += lift(gx, gy) * cross(ex, ey, fx, fy);
+  return exact.sign();
+}
+} // namespace detail
+
+// Positive when c lies to the left of the line from a to b, negative to
+// the right, zero when the three are collinear.
+inline int orient2d(const Point& a, const Point& b, const Point& c) {
+  double l = (b.x - a.x) * (c.y - a.y), r = (b.y - a.y) * (c.x - a.x);
+  double det = l - r;
+  double bound = 3.3306690738754716e-16 * (std::abs(l) + std::abs(r));
+  if (det > bound || -det > bound)
+    return det > 0 ? 1 : -1;
+  return detail::orient2d_exact(a, b, c);
+}
+
+// Positive when d lies inside the circle through a, b and c, which must
+// be in CCW order; negative outside, zero on the circle.
+inline int incircle(const Point& a, const Point& b, const Point& c,
+                    const Point& d) {
+  double adx = a.x - d.x, ady = a.y - d.y, bdx = b.x - d.x, bdy = b.y - d.y,
+         cdx = c.x - d.x, cdy = c.y - d.y;
+  double bc = bdx * cdy - cdx * bdy, ca = cdx * ady - adx * cdy,
+         ab = adx * bdy - bdx * ady;
+  double alift = adx * adx + ady * ady, blift = bdx * bdx + bdy * bdy,
+         clift = cdx * cdx + cdy * cdy;
+  double det = alift * bc + blift * ca + clift * ab;
+  double permanent = (std::abs(bdx * cdy) + std::abs(cdx * bdy)) * alift +
+                     (std::abs(cdx * ady) + std::abs(adx * cdy)) * blift +
+                     (std::abs(adx * bdy) + std::abs(bdx * ady)) * clift;
+  double bound = 1.1102230246251577e-15 * permanent;
+  if (det > bound || -det > bound)
+    return det > 0 ? 1 : -1;
+  // Every product is zero, as when d is one of a, b and c.
+  if (permanent == 0)
+    return 0;
+  return detail::incircle_exact(a, b, c, d);
+}
+} // namespace plane
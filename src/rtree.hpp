@@ -0,0 +1,252 @@
+#pragma once
+#include "parallel.hpp"
+#include "plane.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace plane {
+struct Box {
+  double min_x, min_y, max_x, max_y;
+
+  static constexpr Box empty() {
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    return {inf, inf, -inf, -inf};
+  }
+  constexpr bool overlaps(const Box& b) const {
+    return min_x <= b.max_x && b.min_x <= max_x && min_y <= b.max_y &&
+           b.min_y <= max_y;
+  }
+  constexpr bool contains(const Point& p) const {
+    return min_x <= p.x && p.x <= max_x && min_y <= p.y && p.y <= max_y;
+  }
+  constexpr Box merged(const Box& b) const {
+    return {std::min(min_x, b.min_x), std::min(min_y, b.min_y),
+            std::max(max_x, b.max_x), std::max(max_y, b.max_y)};
+  }
+  constexpr Point center() const {
+    return {(min_x + max_x) / 2, (min_y + max_y) / 2};
+  }
+  constexpr double distance2(const Point& p) const {
+    double dx = std::max({min_x - p.x, 0.0, p.x - max_x});
+    double dy = std::max({min_y - p.y, 0.0, p.y - max_y});
+    return dx * dx + dy * dy;
+  }
+};
+
+constexpr Box bounding_box(const Box& b) { return b; }
+constexpr Box bounding_box(const Segment& s) {
+  return {std::min(s.a.x, s.b.x), std::min(s.a.y, s.b.y),
+          std::max(s.a.x, s.b.x), std::max(s.a.y, s.b.y)};
+}
+constexpr double distance2(const Box& b, const Point& p) {
+  return b.distance2(p);
+}
+constexpr double distance2(const Segment& s, const Point& p) {
+  return s.distance2(p);
+}
+
+// Sort-Tile-Recursive packed R-tree. Ids returned by queries are indices
+// into the span the tree was built from.
+template <typename Item>
+class RTree {
+public:
+  static constexpr uint32_t fanout = 8;
+  static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+private:
+  // Lanes are stored column-wise so overlap tests over a node compile to
+  // straight-line vector compares. Unused lanes hold Box::empty().
+  struct alignas(64) Node {
+    double min_x[fanout], min_y[fanout], max_x[fanout], max_y[fanout];
+    uint32_t child[fanout];
+    uint32_t count;
+    bool leaf;
+  };
+
+  struct Entry {
+    Box box;
+    uint32_t index;
+  };
+
+  std::vector<Item> items_;
+  std::vector<uint32_t> ids_;
+  std::vector<Node> nodes_;
+  uint32_t root_ = npos;
+
+  static uint32_t overlap_mask_(const Node& node, const Box& q) {
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < fanout; i++) {
+      bool hit = (node.min_x[i] <= q.max_x) & (q.min_x <= node.max_x[i]) &
+                 (node.min_y[i] <= q.max_y) & (q.min_y <= node.max_y[i]);
+      mask |= uint32_t(hit) << i;
+    }
+    return mask;
+  }
+
+  static Box lane_box_(const Node& node, uint32_t i) {
+    return {node.min_x[i], node.min_y[i], node.max_x[i], node.max_y[i]};
+  }
+
+  std::vector<Entry> pack_(std::vector<Entry>& entries, bool leaf,
+                           unsigned threads) {
+    size_t n = entries.size();
+    size_t node_count = (n + fanout - 1) / fanout;
+    size_t slices = static_cast<size_t>(std::ceil(std::sqrt(double(node_count))));
+    size_t per_slice = slices * fanout;
+
+    auto by_x = [](const Entry& a, const Entry& b) {
+      return a.box.center().x < b.box.center().x;
+    };
+    auto by_y = [](const Entry& a, const Entry& b) {
+      return a.box.center().y < b.box.center().y;
+    };
+    std::sort(entries.begin(), entries.end(), by_x);
+    lib::parallel_for(
+        (n + per_slice - 1) / per_slice,
+        [&](size_t begin, size_t end) {
+          for (size_t s = begin; s < end; s++)
+            std::sort(entries.begin() + s * per_slice,
+                      entries.begin() + std::min(n, (s + 1) * per_slice), by_y);
+        },
+        threads);
+
+    std::vector<Entry> parents;
+    parents.reserve(node_count);
+    for (size_t first = 0; first < n; first += fanout) {
+      Node node;
+      node.leaf = leaf;
+      node.count = static_cast<uint32_t>(std::min<size_t>(fanout, n - first));
+      Box box = Box::empty();
+      for (uint32_t i = 0; i < fanout; i++) {
+        Box b = Box::empty();
+        node.child[i] = npos;
+        if (i < node.count) {
+          const Entry& e = entries[first + i];
+          b = e.box;
+          if (leaf) {
+            node.child[i] = static_cast<uint32_t>(ids_.size());
+            ids_.push_back(e.index);
+          } else {
+            node.child[i] = e.index;
+          }
+        }
+        node.min_x[i] = b.min_x, node.min_y[i] = b.min_y;
+        node.max_x[i] = b.max_x, node.max_y[i] = b.max_y;
+        box = box.merged(b);
+      }
+      parents.push_back({box, static_cast<uint32_t>(nodes_.size())});
+      nodes_.push_back(node);
+    }
+    return parents;
+  }
+
+public:
+  RTree() = default;
+  explicit RTree(std::span<const Item> items, unsigned threads = 1) {
+    if (items.empty())
+      return;
+    std::vector<Entry> entries(items.size());
+    for (size_t i = 0; i < items.size(); i++)
+      entries[i] = {bounding_box(items[i]), static_cast<uint32_t>(i)};
+
+    ids_.reserve(items.size());
+    auto level = pack_(entries, true, threads);
+    items_.reserve(items.size());
+    for (uint32_t id : ids_)
+      items_.push_back(items[id]);
+    while (level.size() > 1)
+      level = pack_(level, false, threads);
+    root_ = level.front().index;
+  }
+
+  size_t size() const { return items_.size(); }
+  bool empty() const { return items_.empty(); }
+
+  template <typename F>
+  void query(const Box& window, F&& f) const {
+    if (root_ == npos)
+      return;
+    uint32_t stack[128];
+    size_t top = 0;
+    stack[top++] = root_;
+    while (top > 0) {
+      const Node& node = nodes_[stack[--top]];
+      for (uint32_t mask = overlap_mask_(node, window); mask; mask &= mask - 1) {
+        uint32_t child = node.child[std::countr_zero(mask)];
+        if (node.leaf)
+          f(ids_[child], items_[child]);
+        else
+          stack[top++] = child;
+      }
+    }
+  }
+
+  std::vector<uint32_t> query(const Box& window) const {
+    std::vector<uint32_t> result;
+    query(window, [&result](uint32_t id, const Item&) { result.push_back(id); });
+    return result;
+  }
+
+  std::vector<std::vector<uint32_t>> batch_query(std::span<const Box> windows,
+                                                 unsigned threads = 1) const {
+    std::vector<std::vector<uint32_t>> result(windows.size());
+    lib::parallel_for(
+        windows.size(),
+        [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; i++)
+            result[i] = query(windows[i]);
+        },
+        threads);
+    return result;
+  }
+
+  std::optional<uint32_t> nearest(const Point& p) const {
+    if (root_ == npos)
+      return std::nullopt;
+    using Candidate = std::pair<double, uint32_t>;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>> queue;
+    queue.push({0.0, root_});
+    double best = std::numeric_limits<double>::infinity();
+    uint32_t best_id = npos;
+    while (!queue.empty() && queue.top().first < best) {
+      const Node& node = nodes_[queue.top().second];
+      queue.pop();
+      for (uint32_t i = 0; i < node.count; i++) {
+        if (node.leaf) {
+          double d = distance2(items_[node.child[i]], p);
+          if (d < best)
+            best = d, best_id = ids_[node.child[i]];
+        } else {
+          double d = lane_box_(node, i).distance2(p);
+          if (d < best)
+            queue.push({d, node.child[i]});
+        }
+      }
+    }
+    return best_id;
+  }
+
+  std::vector<uint32_t> batch_nearest(std::span<const Point> points,
+                                      unsigned threads = 1) const {
+    std::vector<uint32_t> result(points.size(), npos);
+    lib::parallel_for(
+        points.size(),
+        [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; i++)
+            result[i] = nearest(points[i]).value_or(npos);
+        },
+        threads);
+    return result;
+  }
+};
+} // namespace plane
@@ -0,0 +1,207 @@
+#pragma once
+#include "io/io.hpp"
+#include "plane.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace plane {
+struct DouglasPeuckerKernel {
+  double tolerance;
+  std::vector<std::pair<uint32_t, uint32_t>> stack;
+
+  DouglasPeuckerKernel(double tolerance, size_t window)
+      : tolerance(tolerance) {
+    stack.reserve(window);
+  }
+
+  void mark(std::span<const Point> points, std::span<uint8_t> keep) {
+    size_t n = points.size();
+    std::fill(keep.begin(), keep.end(), 0);
+    keep[0] = keep[n - 1] = 1;
+    double limit = tolerance * tolerance;
+    stack.assign(1, {0, static_cast<uint32_t>(n - 1)});
+    while (!stack.empty()) {
+      auto [i, j] = stack.back();
+      stack.pop_back();
+      Segment chord{points[i], points[j]};
+      double best = -1;
+      uint32_t split = i;
+      for (uint32_t k = i + 1; k < j; k++) {
+        double d = chord.distance2(points[k]);
+        if (d > best)
+          best = d, split = k;
+      }
+      if (best <= limit)
+        continue;
+      keep[split] = 1;
+      stack.push_back({i, split});
+      stack.push_back({split, j});
+    }
+  }
+};
+
+// Removes points whose effective triangle area is below min_area. All
+// bookkeeping lives in arrays sized once for the window, including the
+// indexed min-heap, so a steady stream does no allocation.
+struct VisvalingamKernel {
+  double min_area;
+  std::vector<double> area;
+  std::vector<uint32_t> prev, next, heap, pos;
+
+  VisvalingamKernel(double min_area, size_t window)
+      : min_area(min_area), area(window), prev(window), next(window),
+        heap(window), pos(window) {}
+
+  void mark(std::span<const Point> points, std::span<uint8_t> keep) {
+    size_t n = points.size();
+    std::fill(keep.begin(), keep.end(), 1);
+    if (n < 3)
+      return;
+
+    auto triangle = [&](uint32_t i) {
+      return std::abs((points[i] - points[prev[i]])
+                          .cross(points[next[i]] - points[prev[i]])) /
+             2;
+    };
+    size_t size = 0;
+    auto swap_at = [&](size_t a, size_t b) {
+      std::swap(heap[a], heap[b]);
+      pos[heap[a]] = static_cast<uint32_t>(a);
+      pos[heap[b]] = static_cast<uint32_t>(b);
+    };
+    auto sift_up = [&](size_t h) {
+      while (h > 0 && area[heap[(h - 1) / 2]] > area[heap[h]]) {
+        swap_at(h, (h - 1) / 2);
+        h = (h - 1) / 2;
+      }
+    };
+    auto sift_down = [&](size_t h) {
+      while (true) {
+        size_t l = 2 * h + 1, r = l + 1, m = h;
+        if (l < size && area[heap[l]] < area[heap[m]])
+          m = l;
+        if (r < size && area[heap[r]] < area[heap[m]])
+          m = r;
+        if (m == h)
+          return;
+        swap_at(h, m);
+        h = m;
+      }
+    };
+
+    for (uint32_t i = 0; i < n; i++)
+      prev[i] = i - 1, next[i] = i + 1;
+    for (uint32_t i = 1; i + 1 < n; i++) {
+      area[i] = triangle(i);
+      heap[size] = i;
+      pos[i] = static_cast<uint32_t>(size++);
+    }
+    for (size_t h = size / 2 + 1; h-- > 0;)
+      sift_down(h);
+
+    double floor = 0;
+    while (size > 0 && area[heap[0]] < min_area) {
+      uint32_t i = heap[0];
+      floor = std::max(floor, area[i]);
+      swap_at(0, --size);
+      sift_down(0);
+      keep[i] = 0;
+
+      uint32_t p = prev[i], q = next[i];
+      next[p] = q, prev[q] = p;
+      for (uint32_t k : {p, q}) {
+        if (k == 0 || k + 1 == n)
+          continue;
+        double old = area[k];
+        area[k] = std::max(triangle(k), floor);
+        if (area[k] < old)
+          sift_up(pos[k]);
+        else
+          sift_down(pos[k]);
+      }
+    }
+  }
+};
+
+// Simplifies an unbounded stream in windows of fixed size. Each window is
+// simplified on its own and its last point starts the next one, so
+// window boundaries are always kept and memory stays O(window).
+template <typename Kernel>
+class StreamingSimplifier {
+  Kernel kernel_;
+  size_t capacity_;
+  std::vector<Point> window_;
+  std::vector<uint8_t> keep_;
+
+  template <typename F>
+  void flush_(F& emit, bool final) {
+    if (window_.empty())
+      return;
+    keep_.resize(window_.size());
+    kernel_.mark(window_, keep_);
+    for (size_t i = 0; i + 1 < window_.size(); i++)
+      if (keep_[i])
+        emit(window_[i]);
+    Point last = window_.back();
+    window_.clear();
+    if (final)
+      emit(last);
+    else
+      window_.push_back(last);
+  }
+
+public:
+  StreamingSimplifier(double tolerance, size_t window = 1024)
+      : kernel_(tolerance, std::max<size_t>(window, 3)),
+        capacity_(std::max<size_t>(window, 3)) {
+    window_.reserve(capacity_);
+    keep_.reserve(capacity_);
+  }
+
+  template <typename F>
+  void push(const Point& p, F&& emit) {
+    window_.push_back(p);
+    if (window_.size() == capacity_)
+      flush_(emit, false);
+  }
+
+  template <typename F>
+  void finish(F&& emit) {
+    flush_(emit, true);
+  }
+};
+
+using DouglasPeuckerSimplifier = StreamingSimplifier<DouglasPeuckerKernel>;
+using VisvalingamSimplifier = StreamingSimplifier<VisvalingamKernel>;
+
+template <typename Kernel, typename It, typename Out>
+Out simplify(StreamingSimplifier<Kernel>& s, It first, It last, Out out) {
+  auto emit = [&out](const Point& p) { *out++ = p; };
+  for (; first != last; ++first)
+    s.push(*first, emit);
+  s.finish(emit);
+  return out;
+}
+
+// Reads whitespace separated "x y" pairs until the end of the stream.
+template <typename Kernel, typename F>
+io::Expected<void> simplify(StreamingSimplifier<Kernel>& s, io::Reader& r,
+                            F&& emit) {
+  while (true) {
+    Point p;
+    auto res = r.read_into(p.x);
+    if (!res && res.error() == io::Err::UnexpectedEof)
+      break;
+    if (!res || !(res = r.read_into(p.y)))
+      return res;
+    s.push(p, emit);
+  }
+  s.finish(emit);
+  return {};
+}
+} // namespace plane
@@ -0,0 +1,215 @@
+#pragma once
+#include "parallel.hpp"
+#include "plane.hpp"
+#include "spatial_sort.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace plane {
+class SpatialHash {
+public:
+  using Id = size_t;
+  static constexpr Id npos = std::numeric_limits<Id>::max();
+
+private:
+  struct Entry {
+    Point point;
+    Id id;
+    uint64_t key;
+    size_t cell_index;
+  };
+
+  double cell_size_;
+  std::vector<Entry> entries_;
+  std::vector<size_t> slot_of_;
+  std::vector<Id> free_ids_;
+  std::unordered_map<uint64_t, std::vector<size_t>> cells_;
+
+  int64_t cell_coord_(double v) const {
+    return static_cast<int64_t>(std::floor(v / cell_size_));
+  }
+  static uint64_t key_(int64_t cx, int64_t cy) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) |
+           static_cast<uint32_t>(cy);
+  }
+  uint64_t key_of_(const Point& p) const {
+    return key_(cell_coord_(p.x), cell_coord_(p.y));
+  }
+
+  void link_(size_t slot) {
+    auto& cell = cells_[entries_[slot].key];
+    entries_[slot].cell_index = cell.size();
+    cell.push_back(slot);
+  }
+  void unlink_(size_t slot) {
+    auto it = cells_.find(entries_[slot].key);
+    auto& cell = it->second;
+    size_t i = entries_[slot].cell_index;
+    cell[i] = cell.back();
+    entries_[cell[i]].cell_index = i;
+    cell.pop_back();
+    if (cell.empty())
+      cells_.erase(it);
+  }
+
+public:
+  explicit SpatialHash(double cell_size) : cell_size_(cell_size) {
+    assert(cell_size > 0);
+  }
+
+  double cell_size() const { return cell_size_; }
+  size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+  bool contains(Id id) const {
+    return id < slot_of_.size() && slot_of_[id] != npos;
+  }
+  const Point& at(Id id) const { return entries_[slot_of_[id]].point; }
+
+  Id insert(const Point& p) {
+    Id id;
+    if (free_ids_.empty()) {
+      id = slot_of_.size();
+      slot_of_.push_back(npos);
+    } else {
+      id = free_ids_.back();
+      free_ids_.pop_back();
+    }
+    slot_of_[id] = entries_.size();
+    entries_.push_back({p, id, key_of_(p), 0});
+    link_(entries_.size() - 1);
+    return id;
+  }
+
+  void remove(Id id) {
+    assert(contains(id));
+    size_t slot = slot_of_[id];
+    unlink_(slot);
+    size_t last = entries_.size() - 1;
+    if (slot != last) {
+      entries_[slot] = entries_[last];
+      slot_of_[entries_[slot].id] = slot;
+      cells_[entries_[slot].key][entries_[slot].cell_index] = slot;
+    }
+    entries_.pop_back();
+    slot_of_[id] = npos;
+    free_ids_.push_back(id);
+  }
+
+  void move(Id id, const Point& p) {
+    assert(contains(id));
+    size_t slot = slot_of_[id];
+    uint64_t key = key_of_(p);
+    entries_[slot].point = p;
+    if (key == entries_[slot].key)
+      return;
+    unlink_(slot);
+    entries_[slot].key = key;
+    link_(slot);
+  }
+
+  void clear() {
+    entries_.clear();
+    slot_of_.clear();
+    free_ids_.clear();
+    cells_.clear();
+  }
+
+  template <typename F>
+  void for_each_in_radius(const Point& center, double radius, F&& f) const {
+    double r2 = radius * radius;
+    int64_t x0 = cell_coord_(center.x - radius),
+            x1 = cell_coord_(center.x + radius),
+            y0 = cell_coord_(center.y - radius),
+            y1 = cell_coord_(center.y + radius);
+    auto visit = [&](const std::vector<size_t>& cell) {
+      for (size_t slot : cell) {
+        const Entry& e = entries_[slot];
+        Vector d = e.point - center;
+        if (d * d <= r2)
+          f(e.id, e.point);
+      }
+    };
+    // Keys keep 32 bits of each coordinate, so cells 2^32 apart share a
+    // bucket. A range spanning that many cells also spans more than are
+    // occupied; it scans the table instead, visiting each bucket once.
+    double span =
+        (double(x1) - double(x0) + 1) * (double(y1) - double(y0) + 1);
+    if (span > double(cells_.size())) {
+      for (auto& [key, cell] : cells_)
+        visit(cell);
+      return;
+    }
+    for (int64_t cx = x0; cx <= x1; cx++)
+      for (int64_t cy = y0; cy <= y1; cy++) {
+        auto it = cells_.find(key_(cx, cy));
+        if (it != cells_.end())
+          visit(it->second);
+      }
+  }
+
+  std::vector<Id> query_radius(const Point& center, double radius) const {
+    std::vector<Id> result;
+    for_each_in_radius(center, radius,
+                       [&result](Id id, const Point&) { result.push_back(id); });
+    return result;
+  }
+
+  void compact() {
+    std::stable_sort(entries_.begin(), entries_.end(),
+                     [](const Entry& a, const Entry& b) { return a.key < b.key; });
+    for (auto& [key, cell] : cells_)
+      cell.clear();
+    for (size_t slot = 0; slot < entries_.size(); slot++) {
+      slot_of_[entries_[slot].id] = slot;
+      link_(slot);
+    }
+  }
+
+  void rebuild(std::span<const Point> points, unsigned threads = 0) {
+    clear();
+    std::vector<uint64_t> keys(points.size());
+    lib::parallel_for(
+        points.size(),
+        [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; i++)
+            keys[i] = key_of_(points[i]);
+        },
+        threads);
+
+    assert(points.size() <= std::numeric_limits<uint32_t>::max());
+    auto order = radix_order(keys, threads);
+
+    entries_.resize(points.size());
+    slot_of_.resize(points.size());
+    lib::parallel_for(
+        points.size(),
+        [&](size_t begin, size_t end) {
+          for (size_t slot = begin; slot < end; slot++) {
+            Id id = order[slot];
+            entries_[slot] = {points[id], id, keys[id], 0};
+            slot_of_[id] = slot;
+          }
+        },
+        threads);
+    // Each cell is now one run of slots; only the table itself is built
+    // serially, with one lookup per cell.
+    for (size_t begin = 0, end; begin < entries_.size(); begin = end) {
+      uint64_t key = entries_[begin].key;
+      for (end = begin + 1; end < entries_.size() && entries_[end].key == key;
+           end++)
+        entries_[end].cell_index = end - begin;
+      auto& cell = cells_[key];
+      cell.resize(end - begin);
+      std::iota(cell.begin(), cell.end(), begin);
+    }
+  }
+};
+} // namespace plane
@@ -0,0 +1,195 @@
+#pragma once
+#include "parallel.hpp"
+#include "plane.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace plane {
+enum class Curve { Hilbert, Morton };
+
+inline uint64_t morton_key(uint32_t x, uint32_t y) {
+  auto spread = [](uint64_t v) {
+    v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+    v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+    v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    v = (v | (v << 2)) & 0x3333333333333333ull;
+    v = (v | (v << 1)) & 0x5555555555555555ull;
+    return v;
+  };
+  return spread(x) | (spread(y) << 1);
+}
+
+namespace detail {
+// The orientation of a Hilbert sub-square is a swap of the axes and/or a
+// flip of both. For each orientation and each 4-bit slice of x and y the
+// table holds the 8 key bits produced and the orientation that follows,
+// packed as (bits << 2) | (flip << 1) | swap.
+constexpr std::array<std::array<uint16_t, 256>, 4> make_hilbert_table() {
+  std::array<std::array<uint16_t, 256>, 4> table{};
+  for (uint32_t state = 0; state < 4; state++)
+    for (uint32_t slice = 0; slice < 256; slice++) {
+      uint32_t swap = state & 1, flip = state >> 1, bits = 0;
+      for (int i = 3; i >= 0; i--) {
+        uint32_t bx = ((slice >> (4 + i)) & 1) ^ flip;
+        uint32_t by = ((slice >> i) & 1) ^ flip;
+        uint32_t rx = swap ? by : bx, ry = swap ? bx : by;
+        bits = (bits << 2) | ((3 * rx) ^ ry);
+        if (ry == 0) {
+          flip ^= rx;
+          swap ^= 1;
+        }
+      }
+      table[state][slice] =
+          static_cast<uint16_t>((bits << 2) | (flip << 1) | swap);
+    }
+  return table;
+}
+
+inline constexpr auto hilbert_table = make_hilbert_table();
+} // namespace detail
+
+inline uint64_t hilbert_key(uint32_t x, uint32_t y) {
+  uint64_t d = 0;
+  uint32_t state = 0;
+  for (int i = 28; i >= 0; i -= 4) {
+    uint32_t slice = ((x >> i) & 15) << 4 | ((y >> i) & 15);
+    uint32_t entry = detail::hilbert_table[state][slice];
+    d = (d << 8) | (entry >> 2);
+    state = entry & 3;
+  }
+  return d;
+}
+
+// Maps the bounding square of a point set onto the 32-bit grid.
+struct Quantizer {
+  double min_x, min_y, scale;
+
+  static Quantizer of(std::span<const Point> points) {
+    if (points.empty())
+      return {0, 0, 0};
+    double min_x = points[0].x, max_x = min_x, min_y = points[0].y,
+           max_y = min_y;
+    for (auto& p : points) {
+      min_x = std::min(min_x, p.x), max_x = std::max(max_x, p.x);
+      min_y = std::min(min_y, p.y), max_y = std::max(max_y, p.y);
+    }
+    double span = std::max(max_x - min_x, max_y - min_y);
+    return {min_x, min_y, span > 0 ? 4294967295.0 / span : 0.0};
+  }
+
+  uint32_t x(double v) const { return cell_((v - min_x) * scale); }
+  uint32_t y(double v) const { return cell_((v - min_y) * scale); }
+
+private:
+  static uint32_t cell_(double v) {
+    return static_cast<uint32_t>(std::clamp(v, 0.0, 4294967295.0));
+  }
+};
+
+inline std::vector<uint64_t> curve_keys(std::span<const Point> points,
+                                        Curve curve = Curve::Hilbert,
+                                        unsigned threads = 0) {
+  Quantizer q = Quantizer::of(points);
+  std::vector<uint64_t> keys(points.size());
+  lib::parallel_for(
+      points.size(),
+      [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+          uint32_t x = q.x(points[i].x), y = q.y(points[i].y);
+          keys[i] = curve == Curve::Hilbert ? hilbert_key(x, y)
+                                            : morton_key(x, y);
+        }
+      },
+      threads);
+  return keys;
+}
+
+// Stable LSD radix sort of indices by 64-bit key, eight bits per pass.
+// Each block of the input gets its own histogram, so the counting and
+// scatter phases both run in parallel; passes whose digit is the same
+// for every key are skipped.
+inline std::vector<uint32_t> radix_order(std::span<const uint64_t> keys,
+                                         unsigned threads = 0) {
+  struct Item {
+    uint64_t key;
+    uint32_t index;
+  };
+  size_t n = keys.size();
+  std::vector<Item> items(n), tmp(n);
+  for (size_t i = 0; i < n; i++)
+    items[i] = {keys[i], static_cast<uint32_t>(i)};
+
+  if (threads == 0)
+    threads = lib::hardware_threads();
+  size_t blocks = std::max<size_t>(1, std::min<size_t>(threads, n / 4096));
+  auto block_begin = [n, blocks](size_t b) { return b * n / blocks; };
+  std::vector<std::array<size_t, 256>> hist(blocks);
+
+  for (unsigned shift = 0; shift < 64; shift += 8) {
+    lib::parallel_for(
+        blocks,
+        [&](size_t b0, size_t b1) {
+          for (size_t b = b0; b < b1; b++) {
+            hist[b].fill(0);
+            for (size_t i = block_begin(b); i < block_begin(b + 1); i++)
+              hist[b][(items[i].key >> shift) & 0xFF]++;
+          }
+        },
+        static_cast<unsigned>(blocks));
+
+    std::array<size_t, 256> total{};
+    for (auto& h : hist)
+      for (size_t d = 0; d < 256; d++)
+        total[d] += h[d];
+    if (std::find(total.begin(), total.end(), n) != total.end())
+      continue;
+
+    size_t offset = 0;
+    for (size_t d = 0; d < 256; d++)
+      for (auto& h : hist) {
+        size_t count = h[d];
+        h[d] = offset;
+        offset += count;
+      }
+
+    lib::parallel_for(
+        blocks,
+        [&](size_t b0, size_t b1) {
+          for (size_t b = b0; b < b1; b++)
+            for (size_t i = block_begin(b); i < block_begin(b + 1); i++)
+              tmp[hist[b][(items[i].key >> shift) & 0xFF]++] = items[i];
+        },
+        static_cast<unsigned>(blocks));
+    items.swap(tmp);
+  }
+
+  std::vector<uint32_t> order(n);
+  for (size_t i = 0; i < n; i++)
+    order[i] = items[i].index;
+  return order;
+}
+
+inline std::vector<uint32_t> spatial_order(std::span<const Point> points,
+                                           Curve curve = Curve::Hilbert,
+                                           unsigned threads = 0) {
+  return radix_order(curve_keys(points, curve, threads), threads);
+}
+
+inline void spatial_sort(std::span<Point> points, Curve curve = Curve::Hilbert,
+                         unsigned threads = 0) {
+  auto order = spatial_order(points, curve, threads);
+  std::vector<Point> sorted(points.size());
+  lib::parallel_for(
+      points.size(),
+      [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+          sorted[i] = points[order[i]];
+      },
+      threads);
+  std::copy(sorted.begin(), sorted.end(), points.begin());
+}
+} // namespace plane
@@ -0,0 +1,332 @@
+#pragma once
+#include "parallel.hpp"
+#include "plane.hpp"
+#include "predicates.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace plane {
+// Randomized incremental trapezoidal map with its search DAG. Segments may
+// share endpoints but must not otherwise intersect; zero-length segments
+// are ignored; crossings that the build runs into throw
+// std::invalid_argument. Points are ordered lexicographically, which acts
+// as a symbolic shear so equal x coordinates need no special casing.
+//
+// Only the DAG survives the build. Its nodes are renumbered in depth-first
+// order so a query walks mostly forward through one contiguous array, and
+// leaves hold the answer directly.
+class TrapezoidMap {
+public:
+  static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+  // Indices of the input segments directly above and below the query
+  // point, npos where nothing lies in that direction. They bound the
+  // trapezoid containing the point; a non-convex face can have several
+  // such pairs, so they do not name the face by themselves.
+  struct Location {
+    uint32_t above, below;
+  };
+
+private:
+  enum class Kind : uint32_t { X, Y, Leaf };
+
+  // X: ref is a point, left/right are the lexicographically smaller and
+  // larger sides. Y: ref is a segment, left/right are above/below.
+  // Leaf: left/right are the segments above/below.
+  struct Node {
+    Kind kind;
+    uint32_t ref, left, right;
+  };
+
+  struct Trapezoid {
+    uint32_t top, bottom, leftp, rightp;
+    // Neighbors across the left and right walls, just above and just
+    // below the wall's defining point; npos where that part is empty.
+    uint32_t ul, ll, ur, lr;
+    uint32_t node;
+  };
+
+  // Segment i runs from points_[2 * i] to points_[2 * i + 1], left to
+  // right; two sentinels at infinity bound the map during the build.
+  std::vector<Point> points_;
+  std::vector<Node> nodes_;
+  size_t size_ = 0;
+
+  static bool before_(const Point& a, const Point& b) {
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+  }
+  static bool same_(const Point& a, const Point& b) {
+    return a.x == b.x && a.y == b.y;
+  }
+  bool above_(uint32_t segment, const Point& p) const {
+    return orient2d(points_[2 * segment], points_[2 * segment + 1], p) > 0;
+  }
+
+  // Build state, released once the DAG is compacted.
+  struct Builder {
+    TrapezoidMap& map;
+    std::vector<Trapezoid> traps{};
+    std::vector<uint32_t> crossed{}, up{}, lo{}, old{}, slot{};
+    std::vector<Trapezoid> fresh{};
+
+    const Point& pt(uint32_t i) const { return map.points_[i]; }
+
+    uint32_t leaf_(uint32_t t) {
+      traps[t].node = static_cast<uint32_t>(map.nodes_.size());
+      map.nodes_.push_back({Kind::Leaf, t, 0, 0});
+      slot.push_back(npos);
+      return traps[t].node;
+    }
+    uint32_t add_(const Trapezoid& t) {
+      traps.push_back(t);
+      return leaf_(static_cast<uint32_t>(traps.size() - 1));
+    }
+
+    // The leaf whose trapezoid starts at p and contains the beginning of
+    // the segment p -> q.
+    uint32_t locate_(const Point& p, const Point& q) const {
+      uint32_t n = 0;
+      while (map.nodes_[n].kind != Kind::Leaf) {
+        const Node& node = map.nodes_[n];
+        if (node.kind == Kind::X) {
+          n = before_(p, pt(node.ref)) ? node.left : node.right;
+        } else {
+          const Point &a = pt(2 * node.ref), &b = pt(2 * node.ref + 1);
+          int o = orient2d(a, b, p);
+          if (o == 0)
+            o = orient2d(a, b, q);
+          n = o > 0 ? node.left : node.right;
+        }
+      }
+      return map.nodes_[n].ref;
+    }
+
+    void insert(uint32_t s) {
+      uint32_t pi = 2 * s, qi = 2 * s + 1;
+      const Point &p = pt(pi), &q = pt(qi);
+
+      crossed.assign(1, locate_(p, q));
+      while (before_(pt(traps[crossed.back()].rightp), q)) {
+        const Trapezoid& t = traps[crossed.back()];
+        uint32_t next = orient2d(p, q, pt(t.rightp)) > 0 ? t.lr : t.ur;
+        // Only crossing segments can walk off the map.
+        if (next == npos)
+          throw std::invalid_argument("segments intersect");
+        crossed.push_back(next);
+      }
+      size_t k = crossed.size() - 1;
+      for (size_t j = 0; j <= k; j++)
+        slot[crossed[j]] = static_cast<uint32_t>(j);
+
+      const Trapezoid first = traps[crossed[0]], last = traps[crossed[k]];
+      uint32_t a = npos, b = npos;
+      size_t base = traps.size();
+      if (before_(pt(first.leftp), p))
+        a = static_cast<uint32_t>(base++);
+      if (before_(q, pt(last.rightp)))
+        b = static_cast<uint32_t>(base++);
+
+      // Pieces above and below s; consecutive pieces merge where s passes
+      // the wall on the side away from the wall's point.
+      up.resize(k + 1);
+      lo.resize(k + 1);
+      for (size_t j = 0; j <= k; j++) {
+        bool wall_above =
+            j > 0 && orient2d(p, q, pt(traps[crossed[j]].leftp)) > 0;
+        up[j] =
+            j > 0 && !wall_above ? up[j - 1] : static_cast<uint32_t>(base++);
+        lo[j] = j > 0 && wall_above ? lo[j - 1] : static_cast<uint32_t>(base++);
+      }
+
+      // What a reference to crossed trapezoid t from the wall at point w,
+      // on the upper or lower side of w, refers to after the split.
+      auto remap = [&](uint32_t t, uint32_t w, bool upper) {
+        if (t >= slot.size() || slot[t] == npos)
+          return t;
+        const Point& wp = pt(w);
+        if (before_(wp, p))
+          return a;
+        if (before_(q, wp))
+          return b;
+        bool side = same_(wp, p) || same_(wp, q) ? upper
+                                                  : orient2d(p, q, wp) > 0;
+        return side ? up[slot[t]] : lo[slot[t]];
+      };
+
+      fresh.assign(base - traps.size(), {});
+      auto at = [&](uint32_t id) -> Trapezoid& {
+        return fresh[id - traps.size()];
+      };
+      if (a != npos)
+        at(a) = {first.top, first.bottom, first.leftp, pi,
+                 first.ul,  first.ll,     up[0],       lo[0], npos};
+      if (b != npos)
+        at(b) = {last.top, last.bottom, qi,      last.rightp,
+                 up[k],    lo[k],       last.ur, last.lr, npos};
+      for (size_t j = 0; j <= k; j++) {
+        const Trapezoid& t = traps[crossed[j]];
+        bool starts = j == 0 || up[j] != up[j - 1];
+        bool ends = j == k || up[j] != up[j + 1];
+        Trapezoid& u = at(up[j]);
+        if (starts) {
+          u.top = t.top, u.bottom = s;
+          u.leftp = j == 0 ? pi : t.leftp;
+          u.ul = j == 0 ? (a != npos ? a : t.ul) : remap(t.ul, t.leftp, true);
+          u.ll = j == 0 ? npos : remap(t.ll, t.leftp, false);
+        }
+        if (ends) {
+          u.rightp = j == k ? qi : t.rightp;
+          u.ur = j == k ? (b != npos ? b : t.ur) : remap(t.ur, t.rightp, true);
+          u.lr = j == k ? npos : remap(t.lr, t.rightp, false);
+        }
+        starts = j == 0 || lo[j] != lo[j - 1];
+        ends = j == k || lo[j] != lo[j + 1];
+        Trapezoid& l = at(lo[j]);
+        if (starts) {
+          l.top = s, l.bottom = t.bottom;
+          l.leftp = j == 0 ? pi : t.leftp;
+          l.ul = j == 0 ? npos : remap(t.ul, t.leftp, true);
+          l.ll = j == 0 ? (a != npos ? a : t.ll) : remap(t.ll, t.leftp, false);
+        }
+        if (ends) {
+          l.rightp = j == k ? qi : t.rightp;
+          l.ur = j == k ? npos : remap(t.ur, t.rightp, true);
+          l.lr = j == k ? (b != npos ? b : t.lr) : remap(t.lr, t.rightp, false);
+        }
+      }
+
+      // Outside neighbors still point at the trapezoids being replaced.
+      for (uint32_t c : crossed) {
+        const Trapezoid& t = traps[c];
+        for (uint32_t n : {t.ul, t.ll, t.ur, t.lr}) {
+          if (n == npos || slot[n] != npos)
+            continue;
+          Trapezoid& o = traps[n];
+          o.ul = remap(o.ul, o.leftp, true);
+          o.ll = remap(o.ll, o.leftp, false);
+          o.ur = remap(o.ur, o.rightp, true);
+          o.lr = remap(o.lr, o.rightp, false);
+        }
+      }
+
+      // Each old leaf becomes the root of the subtree splitting it.
+      old.resize(k + 1);
+      for (size_t j = 0; j <= k; j++)
+        old[j] = traps[crossed[j]].node;
+      for (uint32_t c : crossed)
+        slot[c] = npos;
+      for (auto& t : fresh)
+        add_(t);
+      auto leaf = [&](uint32_t t) { return traps[t].node; };
+      auto push = [&](const Node& node) {
+        map.nodes_.push_back(node);
+        return static_cast<uint32_t>(map.nodes_.size() - 1);
+      };
+      for (size_t j = 0; j <= k; j++) {
+        Node root{Kind::Y, s, leaf(up[j]), leaf(lo[j])};
+        if (j == k && b != npos)
+          root = {Kind::X, qi, push(root), leaf(b)};
+        if (j == 0 && a != npos)
+          root = {Kind::X, pi, leaf(a), push(root)};
+        map.nodes_[old[j]] = root;
+      }
+    }
+  };
+
+  // Preorder renumbering: the smaller/above child directly follows its
+  // parent. Shared subtrees are emitted once.
+  void compact_(const std::vector<Trapezoid>& traps) {
+    std::vector<uint32_t> index(nodes_.size(), npos), stack{0};
+    std::vector<Node> out;
+    out.reserve(nodes_.size());
+    while (!stack.empty()) {
+      uint32_t n = stack.back();
+      stack.pop_back();
+      if (index[n] != npos)
+        continue;
+      index[n] = static_cast<uint32_t>(out.size());
+      out.push_back(nodes_[n]);
+      if (nodes_[n].kind != Kind::Leaf) {
+        stack.push_back(nodes_[n].right);
+        stack.push_back(nodes_[n].left);
+      }
+    }
+    for (Node& node : out) {
+      if (node.kind == Kind::Leaf) {
+        const Trapezoid& t = traps[node.ref];
+        node = {Kind::Leaf, 0, t.top, t.bottom};
+      } else {
+        node.left = index[node.left];
+        node.right = index[node.right];
+      }
+    }
+    nodes_ = std::move(out);
+  }
+
+public:
+  TrapezoidMap() = default;
+  explicit TrapezoidMap(std::span<const Segment> segments,
+                        uint64_t seed = 0x5eed) {
+    size_ = segments.size();
+    points_.reserve(2 * size_ + 2);
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < size_; i++) {
+      Point a = segments[i].a, b = segments[i].b;
+      if (before_(b, a))
+        std::swap(a, b);
+      points_.push_back(a);
+      points_.push_back(b);
+      if (!same_(a, b))
+        order.push_back(i);
+    }
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    uint32_t lo = static_cast<uint32_t>(points_.size());
+    points_.push_back({-inf, 0});
+    points_.push_back({inf, 0});
+
+    Builder builder{*this};
+    builder.traps.reserve(3 * order.size() + 1);
+    builder.add_({npos, npos, lo, lo + 1, npos, npos, npos, npos, npos});
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(seed));
+    for (uint32_t s : order)
+      builder.insert(s);
+    compact_(builder.traps);
+    points_.resize(2 * size_);
+    points_.shrink_to_fit();
+  }
+
+  size_t size() const { return size_; }
+  size_t node_count() const { return nodes_.size(); }
+
+  Location locate(const Point& p) const {
+    if (nodes_.empty())
+      return {npos, npos};
+    const Node* node = &nodes_[0];
+    while (node->kind != Kind::Leaf) {
+      bool left = node->kind == Kind::X ? before_(p, points_[node->ref])
+                                        : above_(node->ref, p);
+      node = &nodes_[left ? node->left : node->right];
+    }
+    return {node->left, node->right};
+  }
+
+  std::vector<Location> batch_locate(std::span<const Point> points,
+                                     unsigned threads = 0) const {
+    std::vector<Location> result(points.size());
+    lib::parallel_for(
+        points.size(),
+        [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; i++)
+            result[i] = locate(points[i]);
+        },
+        threads);
+    return result;
+  }
+};
+} // namespace plane
@@ -0,0 +1,64 @@
+#include "src/affine.hpp"
+#include <gtest/gtest.h>
+#include <numbers>
+#include <vector>
+
+using namespace plane;
+
+TEST(AffineSuite, Basic) {
+  Point p{1, 2};
+  EXPECT_EQ(Affine2D::identity().apply(p), p);
+  EXPECT_EQ(Affine2D::translation(Vector{3, -1}).apply(p), (Point{4, 1}));
+  EXPECT_EQ(Affine2D::scale(2, 3).apply(p), (Point{2, 6}));
+  EXPECT_EQ(Affine2D::rotation(std::numbers::pi / 2).apply(p), (Point{-2, 1}));
+  EXPECT_EQ(Affine2D::translation(Vector{3, -1}).apply(Vector{1, 2}),
+            (Vector{1, 2}));
+}
+
+TEST(AffineSuite, Composition) {
+  auto t = Affine2D::scale(2, 2).then(Affine2D::translation(Vector{1, 0}));
+  EXPECT_EQ(t.apply(Point{1, 1}), (Point{3, 2}));
+  auto r = Affine2D::rotation(std::numbers::pi, Point{1, 1});
+  EXPECT_EQ(r.apply(Point{2, 1}), (Point{0, 1}));
+
+  auto inv = t.inverse();
+  ASSERT_TRUE(inv.has_value());
+  EXPECT_EQ(*inv * t, Affine2D::identity());
+  EXPECT_FALSE(Affine2D::scale(0, 1).inverse().has_value());
+}
+
+TEST(AffineSuite, MatrixInterop) {
+  auto t = Affine2D::rotation(0.3).then(Affine2D::translation(Vector{5, 6}));
+  Matrix<double> m = t.matrix();
+  EXPECT_EQ(m.rows(), 3);
+  EXPECT_EQ(m[2][2], 1.0);
+  EXPECT_EQ(Affine2D(m), t);
+
+  auto u = Affine2D::scale(2, 0.5);
+  EXPECT_EQ(Affine2D(m * u.matrix()), t * u);
+
+  EXPECT_THROW(Affine2D(Matrix<double>(2, 3)), std::invalid_argument);
+  EXPECT_THROW(Affine2D(Matrix<double>(1.0, 3, 3)), std::invalid_argument);
+}
+
+TEST(AffineSuite, Batch) {
+  auto t = Affine2D::rotation(1.1).then(Affine2D::scale(3, 2));
+  std::vector<Point> in;
+  for (int i = 0; i < 10000; i++)
+    in.push_back(Point{i * 0.5, -i * 0.25});
+
+  std::vector<Point> out(in.size());
+  t.apply(in, out, 4);
+  std::vector<double> xs, ys;
+  for (auto& p : in)
+    xs.push_back(p.x), ys.push_back(p.y);
+  t.apply(xs, ys, 3);
+  t.apply(in);
+  for (size_t i = 0; i < in.size(); i++) {
+    EXPECT_EQ(out[i], in[i]);
+    EXPECT_EQ((Point{xs[i], ys[i]}), in[i]);
+  }
+
+  EXPECT_THROW(t.apply(in, std::span<Point>(out).first(3)),
+               std::invalid_argument);
+}
@@ -0,0 +1,125 @@
+#include "src/io/async.hpp"
+#include <gtest/gtest.h>
+#include <latch>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace io;
+
+namespace {
+std::string pattern(size_t n, size_t seed) {
+  std::string s(n, '\0');
+  for (size_t i = 0; i < n; i++)
+    s[i] = static_cast<char>(i * 131 + seed);
+  return s;
+}
+
+// Writes more than a pipe holds, so both sides have to wait.
+Task<void> produce(AsyncFd w, std::string data, size_t chunk) {
+  auto bytes = std::as_bytes(std::span(data));
+  for (size_t i = 0; i < bytes.size(); i += chunk) {
+    auto slice = bytes.subspan(i, std::min(chunk, bytes.size() - i));
+    auto res = co_await w.write_all(slice);
+    EXPECT_TRUE(res.has_value());
+  }
+}
+
+Task<void> consume(AsyncFd r, std::string expected, bool& ok,
+                   std::latch* done = nullptr) {
+  std::string got(expected.size(), '\0');
+  auto res = co_await r.read_exact(std::as_writable_bytes(std::span(got)));
+  char c;
+  auto eof = co_await r.read(std::as_writable_bytes(std::span(&c, 1)));
+  ok = res.has_value() && got == expected && eof.has_value() && *eof == 0;
+  if (done)
+    done->count_down();
+}
+
+Task<int> answer() { co_return 42; }
+Task<int> sum_answers() { co_return co_await answer() + co_await answer(); }
+Task<int> fail() {
+  throw std::runtime_error("fail");
+  co_return 0;
+}
+Task<void> catch_fail(bool& caught) {
+  try {
+    co_await fail();
+  } catch (const std::runtime_error&) {
+    caught = true;
+  }
+}
+} // namespace
+
+TEST(Task, AwaitAndExceptions) {
+  Reactor reactor;
+  bool caught = false;
+  int sum = 0;
+  reactor.spawn(catch_fail(caught));
+  reactor.spawn([](int& out) -> Task<void> {
+    out = co_await sum_answers();
+  }(sum));
+  reactor.run();
+  EXPECT_TRUE(caught);
+  EXPECT_EQ(sum, 84);
+}
+
+TEST(AsyncFd, PipeRoundTrip) {
+  Reactor reactor;
+  auto p = AsyncFd::pipe(reactor, reactor);
+  ASSERT_TRUE(p.has_value());
+  std::string data = pattern(1 << 20, 1);
+  bool ok = false;
+  reactor.spawn(consume(std::move(p->first), data, ok));
+  reactor.spawn(produce(std::move(p->second), data, 100000));
+  reactor.run();
+  EXPECT_TRUE(ok);
+}
+
+TEST(AsyncFd, ShortStream) {
+  Reactor reactor;
+  auto p = AsyncFd::pipe(reactor, reactor);
+  ASSERT_TRUE(p.has_value());
+  bool ok = true;
+  reactor.spawn(consume(std::move(p->first), std::string(10, 'x'), ok));
+  reactor.spawn(produce(std::move(p->second), std::string(5, 'x'), 5));
+  reactor.run();
+  EXPECT_FALSE(ok);
+}
+
+TEST(AsyncFd, ManyStreamsOneThread) {
+  Reactor reactor;
+  constexpr size_t streams = 200;
+  auto ok = std::make_unique<bool[]>(streams);
+  for (size_t i = 0; i < streams; i++) {
+    auto p = AsyncFd::pipe(reactor, reactor);
+    ASSERT_TRUE(p.has_value());
+    std::string data = pattern(100000 + i, i);
+    reactor.spawn(consume(std::move(p->first), data, ok[i]));
+    reactor.spawn(produce(std::move(p->second), data, 7000));
+  }
+  reactor.run();
+  for (size_t i = 0; i < streams; i++)
+    EXPECT_TRUE(ok[i]) << i;
+}
+
+TEST(ReactorPool, StreamsAcrossReactors) {
+  ReactorPool pool(3);
+  constexpr size_t streams = 30;
+  auto ok = std::make_unique<bool[]>(streams);
+  std::latch done(streams);
+  // Each stream's ends live on different reactors.
+  for (size_t i = 0; i < streams; i++) {
+    Reactor& a = pool.next();
+    Reactor& b = pool.next();
+    auto p = AsyncFd::pipe(a, b);
+    ASSERT_TRUE(p.has_value());
+    std::string data = pattern(200000, i);
+    a.spawn(consume(std::move(p->first), data, ok[i], &done));
+    b.spawn(produce(std::move(p->second), data, 30000));
+  }
+  done.wait();
+  pool.stop();
+  for (size_t i = 0; i < streams; i++)
+    EXPECT_TRUE(ok[i]) << i;
+}
@@ -0,0 +1,155 @@
+#include "src/io/binary.hpp"
+#include "src/io/iobuf.hpp"
+#include "src/io/ioimpl.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace io;
+
+namespace {
+struct Header {
+  uint32_t magic;
+  uint16_t version;
+  double scale;
+};
+
+std::vector<uint8_t> bytes_of(StringReaderWriter& s) {
+  auto buf = s.fill_buf();
+  auto p = reinterpret_cast<const uint8_t*>(buf->data());
+  return {p, p + buf->size()};
+}
+
+// Hides the BufRead side so the byte-at-a-time paths run.
+class Unbuffered : public Reader {
+  Reader& inner_;
+
+public:
+  explicit Unbuffered(Reader& inner) : inner_(inner) {}
+  Expected<size_t> read(std::span<std::byte> buf) override {
+    return inner_.read(buf.first(std::min<size_t>(buf.size(), 3)));
+  }
+};
+} // namespace
+
+TEST(Binary, PodsAreLittleEndian) {
+  StringReaderWriter s;
+  uint32_t v = 0x01020304;
+  Header h{0xCAFE, 3, 0.5};
+  Expected<void> res = s << binary(v) << binary(h);
+  ASSERT_TRUE(res.has_value());
+  auto out = bytes_of(s);
+  ASSERT_EQ(out.size(), 4 + sizeof(Header));
+  EXPECT_EQ(out[0], 4);
+  EXPECT_EQ(out[3], 1);
+
+  uint32_t v2 = 0;
+  Header h2{};
+  res = s >> binary(v2) >> binary(h2);
+  ASSERT_TRUE(res.has_value());
+  EXPECT_EQ(v2, v);
+  EXPECT_EQ(h2.magic, h.magic);
+  EXPECT_EQ(h2.version, h.version);
+  EXPECT_EQ(h2.scale, h.scale);
+}
+
+TEST(Binary, Varints) {
+  StringReaderWriter s;
+  uint32_t small = 300;
+  int64_t minus_one = -1;
+  Expected<void> res = s << varint(small) << varint(minus_one);
+  ASSERT_TRUE(res.has_value());
+  EXPECT_EQ(bytes_of(s), (std::vector<uint8_t>{0xAC, 0x02, 0x01}));
+
+  std::vector<uint64_t> unsigned_values = {
+      0, 1, 127, 128, 16383, 16384, std::numeric_limits<uint64_t>::max()};
+  std::vector<int64_t> signed_values = {0, -1, 1, -64, 64,
+                                        std::numeric_limits<int64_t>::min(),
+                                        std::numeric_limits<int64_t>::max()};
+  StringReaderWriter t;
+  for (auto& u : unsigned_values)
+    ASSERT_TRUE(t.write_from(varint(u)).has_value());
+  for (auto& i : signed_values)
+    ASSERT_TRUE(t.write_from(varint(i)).has_value());
+  for (bool buffered : {true, false}) {
+    StringReaderWriter in{std::string(
+        reinterpret_cast<const char*>(t.fill_buf()->data()),
+        t.fill_buf()->size())};
+    Unbuffered raw(in);
+    Reader& r = buffered ? static_cast<Reader&>(in) : raw;
+    for (auto u : unsigned_values) {
+      uint64_t got;
+      ASSERT_TRUE(r.read_into(varint(got)).has_value());
+      EXPECT_EQ(got, u);
+    }
+    for (auto i : signed_values) {
+      int64_t got;
+      ASSERT_TRUE(r.read_into(varint(got)).has_value());
+      EXPECT_EQ(got, i);
+    }
+  }
+}
+
+TEST(Binary, VarintErrors) {
+  uint8_t got8;
+  StringReaderWriter too_big{std::string("\xAC\x02")};
+  EXPECT_EQ(too_big.read_into(varint(got8)).error(), Err::InvalidData);
+
+  uint64_t got;
+  StringReaderWriter too_long{std::string(11, '\x80')};
+  EXPECT_EQ(too_long.read_into(varint(got)).error(), Err::InvalidData);
+
+  StringReaderWriter truncated{std::string("\x80\x80")};
+  Unbuffered raw(truncated);
+  EXPECT_EQ(raw.read_into(varint(got)).error(), Err::UnexpectedEof);
+}
+
+TEST(Binary, StringsAndVectors) {
+  std::string name = "segment", empty;
+  std::vector<double> xs(100000);
+  for (size_t i = 0; i < xs.size(); i++)
+    xs[i] = static_cast<double>(i) * 0.25;
+  std::vector<std::string> words = {"a", "", std::string(300, 'z')};
+  std::vector<std::vector<int>> nested = {{1, 2}, {}, {3}};
+
+  StringReaderWriter s;
+  {
+    BufWriter w(s, 256);
+    Expected<void> res = w << binary(name) << binary(empty) << binary(xs)
+                           << binary(words) << binary(nested);
+    ASSERT_TRUE(res.has_value());
+  }
+  size_t expected_size = (1 + 7) + 1 + (3 + 8 * xs.size()) +
+                         (1 + 2 + 1 + 2 + 300) + (1 + 9 + 1 + 5);
+  EXPECT_EQ(bytes_of(s).size(), expected_size);
+
+  BufReader r(s, 100);
+  std::string name2 = "old", empty2 = "old";
+  std::vector<double> xs2 = {1};
+  std::vector<std::string> words2;
+  std::vector<std::vector<int>> nested2;
+  Expected<void> res = r >> binary(name2) >> binary(empty2) >> binary(xs2) >>
+                       binary(words2) >> binary(nested2);
+  ASSERT_TRUE(res.has_value());
+  EXPECT_EQ(name2, name);
+  EXPECT_EQ(empty2, empty);
+  EXPECT_EQ(xs2, xs);
+  EXPECT_EQ(words2, words);
+  EXPECT_EQ(nested2, nested);
+}
+
+TEST(Binary, TruncatedVector) {
+  StringReaderWriter s;
+  std::vector<uint32_t> v(1000, 7);
+  ASSERT_TRUE(s.write_from(binary(v)).has_value());
+  auto all = bytes_of(s);
+  StringReaderWriter cut{std::string(all.begin(), all.end() - 1)};
+  std::vector<uint32_t> got;
+  EXPECT_EQ(cut.read_into(binary(got)).error(), Err::UnexpectedEof);
+
+  // A huge count fails at the end of the stream, not in allocation.
+  StringReaderWriter bogus{std::string("\xFF\xFF\xFF\xFF\x0F")};
+  EXPECT_EQ(bogus.read_into(binary(got)).error(), Err::UnexpectedEof);
+}
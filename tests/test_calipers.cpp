@@ -0,0 +1,96 @@
+#include "src/calipers.hpp"
+#include "src/hull.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace plane;
+
+static std::vector<Point> random_hull(unsigned seed, size_t n = 500) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> coord(-10, 10);
+  std::vector<Point> pts(n);
+  for (auto& p : pts)
+    p = Point{coord(gen) * 2, coord(gen)};
+  return convex_hull(pts);
+}
+
+static double edge_box_area(const std::vector<Point>& hull, size_t i) {
+  Vector e = hull[(i + 1) % hull.size()] - hull[i];
+  double len = std::sqrt(e * e);
+  Vector u{e.x / len, e.y / len}, v{-u.y, u.x};
+  double lo = 0, hi = 0, h = 0;
+  for (auto& p : hull) {
+    lo = std::min(lo, u * (p - hull[i]));
+    hi = std::max(hi, u * (p - hull[i]));
+    h = std::max(h, v * (p - hull[i]));
+  }
+  return (hi - lo) * h;
+}
+
+TEST(CalipersSuite, Rectangle) {
+  std::vector<Point> rect{{0, 0}, {4, 0}, {4, 3}, {0, 3}};
+  auto d = diameter(rect);
+  EXPECT_DOUBLE_EQ(d.distance, 5);
+  auto w = width(rect);
+  EXPECT_DOUBLE_EQ(w.width, 3);
+  auto box = min_area_rect(rect);
+  EXPECT_NEAR(box.area, 12, 1e-9);
+}
+
+TEST(CalipersSuite, Degenerate) {
+  std::vector<Point> seg{{0, 0}, {3, 4}};
+  EXPECT_DOUBLE_EQ(diameter(seg).distance, 5);
+  EXPECT_DOUBLE_EQ(width(seg).width, 0);
+  EXPECT_DOUBLE_EQ(min_area_rect(seg).area, 0);
+  EXPECT_DOUBLE_EQ(diameter(std::vector<Point>{}).distance, 0);
+}
+
+TEST(CalipersSuite, MatchesBruteForce) {
+  for (unsigned seed = 0; seed < 20; seed++) {
+    auto hull = random_hull(seed);
+    ASSERT_GE(hull.size(), 3);
+
+    double far = 0, thin = INFINITY, area = INFINITY;
+    for (size_t i = 0; i < hull.size(); i++) {
+      for (auto& q : hull) {
+        Vector d = q - hull[i];
+        far = std::max(far, std::sqrt(d * d));
+      }
+      const Point& a = hull[i];
+      const Point& b = hull[(i + 1) % hull.size()];
+      double h = 0;
+      for (auto& q : hull)
+        h = std::max(h, (b - a).cross(q - a));
+      Vector e = b - a;
+      thin = std::min(thin, h / std::sqrt(e * e));
+      area = std::min(area, edge_box_area(hull, i));
+    }
+    EXPECT_NEAR(diameter(hull).distance, far, 1e-9);
+    EXPECT_NEAR(width(hull).width, thin, 1e-9);
+    auto box = min_area_rect(hull);
+    EXPECT_NEAR(box.area, area, 1e-9);
+    for (auto& q : hull) {
+      for (size_t k = 0; k < 4; k++) {
+        const Point& a = box.corners[k];
+        const Point& b = box.corners[(k + 1) % 4];
+        EXPECT_GE((b - a).cross(q - a), -1e-6);
+      }
+    }
+  }
+}
+
+TEST(CalipersSuite, Batch) {
+  std::vector<std::vector<Point>> hulls;
+  for (unsigned seed = 0; seed < 64; seed++)
+    hulls.push_back(random_hull(seed, 100));
+  auto diameters = for_each_hull(hulls, diameter, 4);
+  auto boxes = for_each_hull(
+      hulls, [](std::span<const Point> h) { return min_area_rect(h); }, 4);
+  ASSERT_EQ(diameters.size(), hulls.size());
+  for (size_t i = 0; i < hulls.size(); i++) {
+    EXPECT_DOUBLE_EQ(diameters[i].distance, diameter(hulls[i]).distance);
+    EXPECT_DOUBLE_EQ(boxes[i].area, min_area_rect(hulls[i]).area);
+  }
+}
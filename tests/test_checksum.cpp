@@ -0,0 +1,164 @@
+#include "src/io/checksum.hpp"
+#include "src/io/iobuf.hpp"
+#include "src/io/ioimpl.hpp"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace io;
+
+namespace {
+std::span<const std::byte> bytes(const std::string& s) {
+  return std::as_bytes(std::span(s));
+}
+
+std::vector<std::byte> noise(size_t n) {
+  std::mt19937 gen(9);
+  std::vector<std::byte> v(n);
+  for (auto& b : v)
+    b = std::byte(gen());
+  return v;
+}
+} // namespace
+
+TEST(Crc32c, KnownValues) {
+  EXPECT_EQ(crc32c(bytes("123456789")), 0xE3069283u);
+  EXPECT_EQ(crc32c(bytes(std::string(32, '\0'))), 0x8A9136AAu);
+  EXPECT_EQ(crc32c(bytes(std::string(32, '\xff'))), 0x62A8AB43u);
+  EXPECT_EQ(crc32c({}), 0u);
+}
+
+TEST(Crc32c, Chaining) {
+  auto data = noise(100000);
+  std::span<const std::byte> all(data);
+  uint32_t whole = crc32c(all);
+  for (size_t split : {0, 1, 7, 4096, 12289, 99999})
+    EXPECT_EQ(crc32c(all.subspan(split), crc32c(all.first(split))), whole);
+}
+
+TEST(Crc32c, PortableMatchesDispatch) {
+  auto data = noise(40000);
+  for (size_t offset : {0, 1, 3, 8})
+    for (size_t n : {0, 5, 64, 12288, 12289, 36864, 39000}) {
+      auto src = std::span<const std::byte>(data).subspan(offset, n);
+      uint32_t portable =
+          ~detail::crc32c_portable(~0u, src.data(), nullptr, src.size());
+      EXPECT_EQ(crc32c(src), portable) << offset << " " << n;
+      std::vector<std::byte> copy(n);
+      EXPECT_EQ(crc32c_copy(copy, src), portable);
+      EXPECT_TRUE(std::equal(copy.begin(), copy.end(), src.begin()));
+    }
+}
+
+TEST(ChecksumWriter, BufferedAndUnbuffered) {
+  auto data = noise(50000);
+  uint32_t expected = crc32c(data);
+  StringReaderWriter plain, under_buf;
+  {
+    ChecksumWriter w(plain);
+    Expected<void> res = w.write_all(data);
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(w.checksum(), expected);
+  }
+  {
+    BufWriter buf(under_buf, 1000);
+    ChecksumWriter w(buf);
+    Expected<void> res = w.write_all(data);
+    ASSERT_TRUE(res.has_value());
+    ASSERT_TRUE(w.flush().has_value());
+    EXPECT_EQ(w.checksum(), expected);
+  }
+  auto a = plain.fill_buf(), b = under_buf.fill_buf();
+  EXPECT_TRUE(std::equal(a->begin(), a->end(), data.begin(), data.end()));
+  EXPECT_TRUE(std::equal(b->begin(), b->end(), data.begin(), data.end()));
+}
+
+TEST(ChecksumWriter, FormattedOutput) {
+  StringReaderWriter out;
+  uint32_t crc;
+  {
+    BufWriter buf(out, 64);
+    ChecksumWriter w(buf);
+    for (int i = 0; i < 1000; i++)
+      ASSERT_TRUE(w.write_fmt("{} ", i).has_value());
+    ASSERT_TRUE(w.flush().has_value());
+    crc = w.checksum();
+  }
+  EXPECT_EQ(crc, crc32c(*out.fill_buf()));
+}
+
+TEST(ChecksumReader, ReadAndParse) {
+  std::string text;
+  for (int i = 0; i < 1000; i++)
+    text += std::to_string(i * 13) + " ";
+  uint32_t expected = crc32c(bytes(text));
+
+  StringReaderWriter in{std::string(text)};
+  ChecksumReader r(in);
+  for (int i = 0; i < 1000; i++) {
+    int v;
+    ASSERT_TRUE(r.read_into(v).has_value());
+    EXPECT_EQ(v, i * 13);
+  }
+  std::byte rest[16];
+  auto n = r.read(rest);
+  ASSERT_TRUE(n.has_value());
+  EXPECT_EQ(*n, 0);
+  EXPECT_EQ(r.checksum(), expected);
+
+  StringReaderWriter again{std::string(text)};
+  ChecksumReader copy(again);
+  std::string out(text.size(), '\0');
+  Expected<void> res = copy.read_exact(std::as_writable_bytes(std::span(out)));
+  ASSERT_TRUE(res.has_value());
+  EXPECT_EQ(out, text);
+  EXPECT_EQ(copy.checksum(), expected);
+}
+
+TEST(ChecksumWriter, UnbufferedReserve) {
+  FILE* f = std::tmpfile();
+  ASSERT_NE(f, nullptr);
+  FileReaderWriter file(f);
+  ChecksumWriter w(file);
+  EXPECT_EQ(w.write_buffer(), nullptr);
+  auto space = w.reserve(8);
+  ASSERT_TRUE(space.has_value());
+  EXPECT_TRUE(space->empty());
+  w.commit(8);
+  ASSERT_TRUE(w.write_fmt("{} {}", 12, 34).has_value());
+  EXPECT_EQ(w.checksum(), crc32c(bytes("12 34")));
+  std::fclose(f);
+}
+
+TEST(ChecksumReader, UnbufferedFillBuf) {
+  auto data = noise(5000);
+  FILE* f = std::tmpfile();
+  ASSERT_NE(f, nullptr);
+  std::fwrite(data.data(), 1, data.size(), f);
+  std::rewind(f);
+  FileReaderWriter file(f);
+  ChecksumReader r(file);
+  EXPECT_EQ(r.buffered(), nullptr);
+  std::vector<std::byte> out;
+  std::byte some[5];
+  // Alternate parsing in place with copies out.
+  for (bool parse = true;; parse = !parse) {
+    if (parse) {
+      auto buf = r.fill_buf();
+      ASSERT_TRUE(buf.has_value());
+      if (buf->empty())
+        break;
+      size_t n = buf->size() / 2 + 1;
+      out.insert(out.end(), buf->begin(), buf->begin() + n);
+      r.consume(n);
+    } else {
+      auto n = r.read(some);
+      ASSERT_TRUE(n.has_value());
+      out.insert(out.end(), some, some + *n);
+    }
+  }
+  EXPECT_EQ(out, data);
+  EXPECT_EQ(r.checksum(), crc32c(data));
+  std::fclose(f);
+}
@@ -0,0 +1,117 @@
+#include "src/io/compress.hpp"
+#include "src/io/ioimpl.hpp"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+
+using namespace io;
+
+namespace {
+std::string text(size_t n) {
+  std::mt19937 gen(3);
+  const char* words[] = {"plane ", "point ", "segment ", "hull ", "\n", "42 "};
+  std::string s;
+  while (s.size() < n)
+    s += words[gen() % 6];
+  s.resize(n);
+  return s;
+}
+
+std::string noise(size_t n) {
+  std::mt19937 gen(4);
+  std::string s(n, '\0');
+  for (auto& c : s)
+    c = static_cast<char>(gen());
+  return s;
+}
+
+std::string compress(const std::string& data, CompressOptions opts) {
+  StringReaderWriter out;
+  {
+    CompressWriter w(out, opts);
+    Expected<void> res = w.write_all(std::as_bytes(std::span(data)));
+    EXPECT_TRUE(res.has_value());
+  }
+  auto bytes = out.fill_buf();
+  return std::string(reinterpret_cast<const char*>(bytes->data()),
+                     bytes->size());
+}
+
+Expected<std::string> decompress(const std::string& packed, size_t size,
+                                 unsigned threads) {
+  StringReaderWriter in{std::string(packed)};
+  DecompressReader r(in, threads);
+  std::string out(size, '\0');
+  auto res = r.read_exact(std::as_writable_bytes(std::span(out)));
+  if (!res)
+    return Unexpected(res.error());
+  char c;
+  auto n = r.read(std::as_writable_bytes(std::span(&c, 1)));
+  if (!n)
+    return Unexpected(n.error());
+  EXPECT_EQ(*n, 0);
+  return out;
+}
+} // namespace
+
+TEST(Compress, RoundTrip) {
+  for (const std::string& data : {text(1000000), noise(300000), text(10),
+                                  std::string(), std::string(100000, 'a')})
+    for (unsigned threads : {1u, 4u}) {
+      std::string packed = compress(data, {4096, 16, threads});
+      auto out = decompress(packed, data.size(), 3);
+      ASSERT_TRUE(out.has_value());
+      EXPECT_EQ(*out, data);
+    }
+}
+
+TEST(Compress, Ratio) {
+  std::string data = text(1000000);
+  EXPECT_LT(compress(data, {}).size(), data.size() / 3);
+}
+
+TEST(Compress, IncompressibleStoredRaw) {
+  std::string data = noise(100000);
+  std::string packed = compress(data, {8192, 16, 2});
+  EXPECT_LE(packed.size(), data.size() + 4 + 8 * (data.size() / 8192 + 1));
+}
+
+TEST(Compress, Numbers) {
+  StringReaderWriter buf;
+  {
+    CompressWriter w(buf, {1024, 8, 2});
+    for (int i = 0; i < 100000; i++)
+      ASSERT_TRUE(w.write_fmt("{} ", i % 1000).has_value());
+  }
+  DecompressReader r(buf, 2);
+  for (int i = 0; i < 100000; i++) {
+    int v;
+    ASSERT_TRUE(r.read_into(v).has_value());
+    EXPECT_EQ(v, i % 1000);
+  }
+}
+
+TEST(Compress, Corruption) {
+  std::string data = text(50000);
+  std::string packed = compress(data, {4096, 16, 1});
+  auto truncated =
+      decompress(packed.substr(0, packed.size() - 3), data.size(), 2);
+  ASSERT_FALSE(truncated.has_value());
+  EXPECT_EQ(truncated.error(), Err::UnexpectedEof);
+
+  std::string bad_magic = packed;
+  bad_magic[0] = 'X';
+  EXPECT_FALSE(decompress(bad_magic, data.size(), 2).has_value());
+
+  // Flipping payload bytes must never read or write out of bounds.
+  std::mt19937 gen(5);
+  for (int trial = 0; trial < 200; trial++) {
+    std::string broken = packed;
+    for (int k = 0; k < 4; k++)
+      broken[12 + gen() % (broken.size() - 12)] ^= static_cast<char>(gen());
+    auto out = decompress(broken, data.size(), 2);
+    if (out.has_value()) {
+      EXPECT_EQ(out->size(), data.size());
+    }
+  }
+}
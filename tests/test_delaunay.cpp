@@ -0,0 +1,175 @@
+#include "src/delaunay.hpp"
+#include <algorithm>
+#include <array>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace plane;
+
+static std::vector<Point> random_points(size_t n, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> coord(-100, 100);
+  std::vector<Point> points(n);
+  for (auto& p : points)
+    p = Point{coord(gen), coord(gen)};
+  return points;
+}
+
+static double area(const Point& a, const Point& b, const Point& c) {
+  return ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x)) / 2;
+}
+
+static void check_topology(const Delaunay& d) {
+  auto pts = d.points();
+  auto& tris = d.triangles();
+  auto& half = d.halfedges();
+  ASSERT_EQ(tris.size(), half.size());
+  for (size_t t = 0; t < d.triangle_count(); t++)
+    EXPECT_GT(
+        orient2d(pts[tris[3 * t]], pts[tris[3 * t + 1]], pts[tris[3 * t + 2]]),
+        0);
+  for (uint32_t e = 0; e < half.size(); e++) {
+    if (half[e] == Delaunay::npos)
+      continue;
+    EXPECT_EQ(half[half[e]], e);
+    EXPECT_EQ(tris[e], tris[Delaunay::next_halfedge(half[e])]);
+    // Locally Delaunay: the opposite vertex is outside the circle.
+    uint32_t t = e - e % 3;
+    uint32_t opposite = tris[Delaunay::prev_halfedge(half[e])];
+    EXPECT_LE(incircle(pts[tris[t]], pts[tris[t + 1]], pts[tris[t + 2]],
+                       pts[opposite]),
+              0);
+  }
+}
+
+// Triangles as sorted vertex triples, in sorted order.
+static std::vector<std::array<uint32_t, 3>> canonical(const Delaunay& d) {
+  std::vector<std::array<uint32_t, 3>> result;
+  auto& tris = d.triangles();
+  for (size_t t = 0; t < tris.size(); t += 3) {
+    std::array<uint32_t, 3> v{tris[t], tris[t + 1], tris[t + 2]};
+    std::sort(v.begin(), v.end());
+    result.push_back(v);
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+TEST(DelaunaySuite, Square) {
+  std::vector<Point> pts{{0, 0}, {1, 0}, {1, 1}, {0, 1}, {0.5, 0.4}};
+  Delaunay d(pts);
+  check_topology(d);
+  EXPECT_EQ(d.triangle_count(), 4);
+}
+
+TEST(DelaunaySuite, RandomEmptyCircumcircle) {
+  auto pts = random_points(400, 1);
+  Delaunay d(pts);
+  check_topology(d);
+
+  size_t hull = 0;
+  for (auto h : d.halfedges())
+    hull += h == Delaunay::npos;
+  EXPECT_EQ(d.triangle_count(), 2 * pts.size() - 2 - hull);
+
+  auto& tris = d.triangles();
+  for (size_t t = 0; t < d.triangle_count(); t++) {
+    Point c = d.circumcenter(t);
+    Vector r = pts[tris[3 * t]] - c;
+    for (auto& p : pts) {
+      Vector v = p - c;
+      EXPECT_GE(v * v, r * r * (1 - 1e-9));
+    }
+  }
+}
+
+TEST(DelaunaySuite, GridDegenerate) {
+  std::vector<Point> pts;
+  for (int i = 0; i < 30; i++)
+    for (int j = 0; j < 30; j++)
+      pts.push_back(Point{double(i), double(j)});
+  Delaunay d(pts);
+  check_topology(d);
+
+  double total = 0;
+  auto& tris = d.triangles();
+  for (size_t t = 0; t < d.triangle_count(); t++)
+    total += area(pts[tris[3 * t]], pts[tris[3 * t + 1]], pts[tris[3 * t + 2]]);
+  EXPECT_NEAR(total, 29.0 * 29.0, 1e-6);
+  EXPECT_EQ(d.triangle_count(), 2 * 29 * 29);
+}
+
+TEST(DelaunaySuite, CollinearAndDuplicates) {
+  std::vector<Point> line{{0, 0}, {1, 1}, {2, 2}, {3, 3}};
+  EXPECT_EQ(Delaunay(line).triangle_count(), 0);
+
+  std::vector<Point> pts{{0, 0}, {0, 0}, {1, 0}, {0, 1}, {1, 0}, {1, 1}};
+  Delaunay d(pts);
+  check_topology(d);
+  EXPECT_EQ(d.triangle_count(), 2);
+}
+
+TEST(DelaunaySuite, DivideAndConquerMatchesIncremental) {
+  auto pts = random_points(40000, 2);
+  Delaunay seq(pts, 1);
+  for (unsigned threads : {2, 4}) {
+    Delaunay par(pts, threads);
+    check_topology(par);
+    EXPECT_EQ(canonical(seq), canonical(par)) << threads;
+  }
+}
+
+TEST(DelaunaySuite, DivideAndConquerDegenerate) {
+  std::vector<Point> grid;
+  for (int i = 0; i < 30; i++)
+    for (int j = 0; j < 30; j++)
+      grid.push_back(Point{double(i), double(j)});
+  Delaunay d(grid, 2);
+  check_topology(d);
+  EXPECT_EQ(d.triangle_count(), 2 * 29 * 29);
+
+  std::vector<Point> line{{0, 0}, {1, 1}, {2, 2}, {3, 3}, {-1, -1}};
+  EXPECT_EQ(Delaunay(line, 2).triangle_count(), 0);
+  std::vector<Point> pts{{0, 0}, {0, 0}, {1, 0}, {0, 1}, {1, 0}, {1, 1}};
+  Delaunay dup(pts, 2);
+  check_topology(dup);
+  EXPECT_EQ(dup.triangle_count(), 2);
+}
+
+TEST(DelaunaySuite, NearCollinear) {
+  // Within 1e-12 of a line; inexact predicates left an inverted
+  // triangle at this size.
+  std::mt19937_64 gen(1);
+  std::uniform_real_distribution<double> unit(0, 1);
+  std::vector<Point> pts(1000000);
+  for (auto& p : pts) {
+    double t = unit(gen);
+    p = Point{t, 0.5 * t + 1e-12 * unit(gen)};
+  }
+  for (unsigned threads : {1, 2}) {
+    Delaunay d(pts, threads);
+    check_topology(d);
+    EXPECT_GT(d.triangle_count(), pts.size());
+  }
+}
+
+TEST(VoronoiSuite, CellsSurroundSites) {
+  auto pts = random_points(300, 3);
+  Delaunay d(pts);
+  auto cells = d.voronoi(2);
+  size_t bounded = 0;
+  for (size_t i = 0; i < pts.size(); i++) {
+    auto& cell = cells[i];
+    ASSERT_FALSE(cell.vertices.empty());
+    if (!cell.bounded)
+      continue;
+    bounded++;
+    for (size_t k = 0; k < cell.vertices.size(); k++) {
+      const Point& a = cell.vertices[k];
+      const Point& b = cell.vertices[(k + 1) % cell.vertices.size()];
+      EXPECT_GE(area(a, b, pts[i]), -1e-9);
+    }
+  }
+  EXPECT_GT(bounded, pts.size() / 2);
+}
@@ -0,0 +1,83 @@
+#include "src/enclosing_circle.hpp"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace plane;
+
+static std::vector<Point> random_cluster(unsigned seed, size_t n) {
+  std::mt19937 gen(seed);
+  std::normal_distribution<double> coord(0, 3);
+  std::vector<Point> pts(n);
+  for (auto& p : pts)
+    p = Point{coord(gen) + seed, coord(gen) - seed};
+  return pts;
+}
+
+// The minimum circle is determined by two or three of its points.
+static double brute_radius(const std::vector<Point>& pts) {
+  auto encloses = [&pts](const Circle& c) {
+    for (auto& p : pts)
+      if (!c.contains(p))
+        return false;
+    return true;
+  };
+  double best = std::numeric_limits<double>::infinity();
+  for (size_t i = 0; i < pts.size(); i++)
+    for (size_t j = i + 1; j < pts.size(); j++) {
+      Circle c = detail::circle_of(pts[i], pts[j]);
+      if (c.radius < best && encloses(c))
+        best = c.radius;
+      for (size_t k = j + 1; k < pts.size(); k++) {
+        Circle t = detail::circle_of(pts[i], pts[j], pts[k]);
+        if (t.radius < best && encloses(t))
+          best = t.radius;
+      }
+    }
+  return best;
+}
+
+TEST(EnclosingCircleSuite, Small) {
+  std::vector<Point> one{{2, 3}};
+  Circle c = min_enclosing_circle(one);
+  EXPECT_EQ(c.center, (Point{2, 3}));
+  EXPECT_EQ(c.radius, 0);
+
+  std::vector<Point> square{{0, 0}, {2, 0}, {2, 2}, {0, 2}, {1, 1}};
+  c = min_enclosing_circle(square);
+  EXPECT_EQ(c.center, (Point{1, 1}));
+  EXPECT_NEAR(c.radius, std::sqrt(2.0), 1e-12);
+}
+
+TEST(EnclosingCircleSuite, Collinear) {
+  std::vector<Point> line{{0, 0}, {3, 3}, {1, 1}, {-1, -1}, {2, 2}};
+  Circle c = min_enclosing_circle(line);
+  EXPECT_EQ(c.center, (Point{1, 1}));
+  EXPECT_NEAR(c.radius, 2 * std::sqrt(2.0), 1e-12);
+}
+
+TEST(EnclosingCircleSuite, MatchesBruteForce) {
+  for (unsigned seed = 1; seed <= 10; seed++) {
+    auto pts = random_cluster(seed, 40);
+    Circle c = min_enclosing_circle(pts);
+    for (auto& p : pts)
+      EXPECT_TRUE(c.contains(p));
+    EXPECT_NEAR(c.radius, brute_radius(pts), 1e-9);
+  }
+}
+
+TEST(EnclosingCircleSuite, Batch) {
+  std::vector<std::vector<Point>> clusters;
+  for (unsigned seed = 1; seed <= 64; seed++)
+    clusters.push_back(random_cluster(seed, 200 + seed));
+  auto copy = clusters;
+  auto circles = min_enclosing_circles(clusters, 4);
+  ASSERT_EQ(circles.size(), clusters.size());
+  for (size_t i = 0; i < clusters.size(); i++) {
+    // The batch seeds cluster i with seed + i, so the results match
+    // exactly.
+    Circle c = min_enclosing_circle(copy[i], 0x5eed + i);
+    EXPECT_EQ(circles[i].center, c.center);
+    EXPECT_EQ(circles[i].radius, c.radius);
+  }
+}
@@ -0,0 +1,123 @@
+#include "src/halfplane.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <numbers>
+#include <random>
+#include <vector>
+
+using namespace plane;
+
+static double polygon_area(const std::vector<Point>& poly) {
+  double area = 0;
+  for (size_t i = 0; i < poly.size(); i++) {
+    const Point& a = poly[i];
+    const Point& b = poly[(i + 1) % poly.size()];
+    area += a.x * b.y - a.y * b.x;
+  }
+  return area / 2;
+}
+
+TEST(HalfPlaneSuite, Side) {
+  HalfPlane left(Line(Point{0, 0}, Point{1, 0}));
+  HalfPlane right(Line(Point{0, 0}, Point{1, 0}), Side::Right);
+  EXPECT_TRUE(left.contains(Point{0, 1}));
+  EXPECT_FALSE(left.contains(Point{0, -1}));
+  EXPECT_TRUE(right.contains(Point{0, -1}));
+}
+
+TEST(HalfPlaneSuite, BoxAndTriangle) {
+  auto box = box_halfplanes(Point{0, 0}, Point{2, 2});
+  auto square = intersect_halfplanes(box);
+  ASSERT_EQ(square.size(), 4);
+  EXPECT_NEAR(polygon_area(square), 4, 1e-9);
+
+  std::vector<HalfPlane> hs(box.begin(), box.end());
+  hs.push_back(HalfPlane(Line(Point{0, 2}, Point{2, 0}), Side::Right));
+  hs.push_back(HalfPlane(Line(Point{0, 1.5}, Point{1.5, 0}), Side::Right));
+  auto tri = intersect_halfplanes(hs);
+  ASSERT_EQ(tri.size(), 3);
+  EXPECT_NEAR(polygon_area(tri), 1.125, 1e-9);
+}
+
+TEST(HalfPlaneSuite, Empty) {
+  auto box = box_halfplanes(Point{0, 0}, Point{1, 1});
+  std::vector<HalfPlane> hs(box.begin(), box.end());
+  hs.push_back(HalfPlane(Line(Point{2, 0}, Vector{0, -1})));
+  EXPECT_TRUE(intersect_halfplanes(hs).empty());
+}
+
+TEST(HalfPlaneSuite, RegularPolygon) {
+  std::vector<HalfPlane> hs;
+  const int n = 1000;
+  for (int i = 0; i < n; i++) {
+    double a = 2 * std::numbers::pi * i / n;
+    Point p{std::cos(a), std::sin(a)};
+    hs.push_back(HalfPlane(Line(p, Vector{-std::sin(a), std::cos(a)})));
+    hs.push_back(HalfPlane(Line(Point{p.x * 2, p.y * 2}, Vector{-std::sin(a), std::cos(a)})));
+  }
+  std::shuffle(hs.begin(), hs.end(), std::mt19937(1));
+  auto poly = intersect_halfplanes(hs);
+  EXPECT_EQ(poly.size(), n);
+  EXPECT_NEAR(polygon_area(poly), std::numbers::pi, 1e-4);
+}
+
+TEST(LpSuite, Optimal) {
+  auto box = box_halfplanes(Point{0, 0}, Point{4, 3});
+  std::vector<HalfPlane> hs(box.begin(), box.end());
+  hs.push_back(HalfPlane(Line(Point{0, 5}, Point{5, 0}), Side::Right));
+  auto res = solve_lp(hs, Vector{1, 1});
+  EXPECT_EQ(res.status, LpStatus::Optimal);
+  EXPECT_NEAR(res.point.x + res.point.y, 5, 1e-9);
+
+  res = solve_lp(hs, Vector{2, 1});
+  EXPECT_EQ(res.status, LpStatus::Optimal);
+  EXPECT_EQ(res.point, (Point{4, 1}));
+}
+
+TEST(LpSuite, InfeasibleAndUnbounded) {
+  std::vector<HalfPlane> hs{HalfPlane(Line(Point{0, 0}, Vector{0, -1})),
+                            HalfPlane(Line(Point{-1, 0}, Vector{0, 1}))};
+  EXPECT_EQ(solve_lp(hs, Vector{1, 0}).status, LpStatus::Infeasible);
+
+  std::vector<HalfPlane> quadrant{HalfPlane(Line(Point{0, 0}, Vector{1, 0})),
+                                  HalfPlane(Line(Point{0, 0}, Vector{0, -1}))};
+  EXPECT_EQ(solve_lp(quadrant, Vector{1, 1}).status, LpStatus::Unbounded);
+  auto res = solve_lp(quadrant, Vector{-1, -1});
+  EXPECT_EQ(res.status, LpStatus::Optimal);
+  EXPECT_EQ(res.point, (Point{0, 0}));
+}
+
+TEST(LpSuite, BoundedObjectiveOnUnboundedRegion) {
+  // A strip: the region is unbounded, but only along x.
+  std::vector<HalfPlane> strip{HalfPlane(Line(Point{0, 0}, Vector{1, 0})),
+                               HalfPlane(Line(Point{0, 1}, Vector{-1, 0}))};
+  auto res = solve_lp(strip, Vector{0, 1});
+  EXPECT_EQ(res.status, LpStatus::Optimal);
+  EXPECT_DOUBLE_EQ(res.point.y, 1);
+  EXPECT_DOUBLE_EQ(res.point.x, 0);
+  res = solve_lp(strip, Vector{0, -1});
+  EXPECT_EQ(res.status, LpStatus::Optimal);
+  EXPECT_DOUBLE_EQ(res.point.y, 0);
+  EXPECT_EQ(solve_lp(strip, Vector{1, 1}).status, LpStatus::Unbounded);
+  EXPECT_EQ(solve_lp(strip, Vector{-1, 0}).status, LpStatus::Unbounded);
+}
+
+TEST(LpSuite, MatchesPolygonVertex) {
+  std::mt19937 gen(5);
+  std::uniform_real_distribution<double> angle(0, 2 * std::numbers::pi);
+  std::vector<HalfPlane> hs;
+  for (int i = 0; i < 500; i++) {
+    double a = angle(gen);
+    hs.push_back(HalfPlane(Line(Point{std::cos(a), std::sin(a)},
+                                Vector{-std::sin(a), std::cos(a)})));
+  }
+  auto poly = intersect_halfplanes(hs);
+  ASSERT_GE(poly.size(), 3);
+  Vector c{0.3, -0.7};
+  double best = -INFINITY;
+  for (auto& p : poly)
+    best = std::max(best, c * (p - Point{0, 0}));
+  auto res = solve_lp(hs, c);
+  ASSERT_EQ(res.status, LpStatus::Optimal);
+  EXPECT_NEAR(c * (res.point - Point{0, 0}), best, 1e-7);
+}
@@ -0,0 +1,35 @@
+#include "src/hull.hpp"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace plane;
+
+TEST(HullSuite, Square) {
+  std::vector<Point> pts{{0, 0}, {1, 1}, {2, 0}, {1, 0}, {2, 2},
+                         {0, 2}, {0, 1}, {2, 2}, {1, 0.5}};
+  auto hull = convex_hull(pts);
+  EXPECT_EQ(hull, (std::vector<Point>{{0, 0}, {2, 0}, {2, 2}, {0, 2}}));
+}
+
+TEST(HullSuite, Degenerate) {
+  EXPECT_TRUE(convex_hull(std::vector<Point>{}).empty());
+  EXPECT_EQ(convex_hull(std::vector<Point>{{1, 1}, {1, 1}}).size(), 1);
+  EXPECT_EQ(convex_hull(std::vector<Point>{{0, 0}, {1, 1}, {2, 2}}).size(), 2);
+}
+
+TEST(HullSuite, RandomIsConvexAndContainsAll) {
+  std::mt19937 gen(1);
+  std::normal_distribution<double> coord(0, 10);
+  std::vector<Point> pts(2000);
+  for (auto& p : pts)
+    p = Point{coord(gen), coord(gen)};
+  auto hull = convex_hull(pts);
+  ASSERT_GE(hull.size(), 3);
+  for (size_t i = 0; i < hull.size(); i++) {
+    const Point& a = hull[i];
+    const Point& b = hull[(i + 1) % hull.size()];
+    for (auto& p : pts)
+      EXPECT_GE((b - a).cross(p - a), -1e-9);
+  }
+}
@@ -146,3 +146,324 @@ TEST(StringReaderWriter, ChainOperatorError) {
   ASSERT_FALSE(res.has_value());
   EXPECT_EQ(res.error(), Err::UnexpectedEof);
 }
+
+TEST(BufReader, FillBufConsume) {
+  StringReaderWriter inner("abcdefghij");
+  BufReader br(inner, 4);
+  auto buf = br.fill_buf();
+  ASSERT_TRUE(buf.has_value());
+  EXPECT_EQ(buf->size(), 4);
+  EXPECT_EQ(static_cast<char>((*buf)[0]), 'a');
+  br.consume(3);
+  buf = br.fill_buf();
+  ASSERT_EQ(buf->size(), 1);
+  EXPECT_EQ(static_cast<char>((*buf)[0]), 'd');
+  br.consume(1);
+
+  std::string out(6, '\0');
+  auto r = br.read(std::as_writable_bytes(std::span(out)));
+  ASSERT_TRUE(r.has_value());
+  EXPECT_EQ(out, "efghij");
+  buf = br.fill_buf();
+  ASSERT_TRUE(buf.has_value());
+  EXPECT_TRUE(buf->empty());
+}
+
+TEST(StringReaderWriter, FillBufIsWholeString) {
+  StringReaderWriter srw("one two");
+  auto buf = srw.fill_buf();
+  ASSERT_TRUE(buf.has_value());
+  EXPECT_EQ(buf->size(), 7);
+  srw.consume(4);
+  std::string word;
+  ASSERT_TRUE(srw.read_into(word).has_value());
+  EXPECT_EQ(word, "two");
+}
+
+TEST(BufReader, TokensAcrossRefills) {
+  StringReaderWriter inner("  alpha   beta\n\tgamma-delta epsilon");
+  BufReader br(inner, 3);
+  std::vector<std::string> words(4);
+  io::Expected<void> res = br >> words[0] >> words[1] >> words[2] >> words[3];
+  ASSERT_TRUE(res.has_value());
+  EXPECT_EQ(words, (std::vector<std::string>{"alpha", "beta", "gamma-delta",
+                                             "epsilon"}));
+  std::string rest;
+  res = br >> rest;
+  ASSERT_FALSE(res.has_value());
+  EXPECT_EQ(res.error(), Err::UnexpectedEof);
+}
+
+TEST(BufReader, NumbersAcrossRefills) {
+  std::string text;
+  for (int i = 0; i < 200; i++)
+    text += std::to_string(i * 7919) + " " + std::to_string(i * 0.125) + "\n";
+  StringReaderWriter inner(std::move(text));
+  BufReader br(inner, 7);
+  for (int i = 0; i < 200; i++) {
+    long n;
+    double d;
+    io::Expected<void> res = br >> n >> d;
+    ASSERT_TRUE(res.has_value()) << i;
+    EXPECT_EQ(n, i * 7919);
+    EXPECT_DOUBLE_EQ(d, i * 0.125);
+  }
+  long n;
+  EXPECT_EQ(br.read_into(n).error(), Err::UnexpectedEof);
+}
+
+TEST(BufReader, NumberErrors) {
+  StringReaderWriter inner("abc " + std::string(300, '1') + " 5");
+  BufReader br(inner, 16);
+  int i;
+  EXPECT_EQ(br.read_into(i).error(), Err::InvalidData);
+  EXPECT_EQ(br.read_into(i).error(), Err::InvalidData);
+  ASSERT_TRUE(br.read_into(i).has_value());
+  EXPECT_EQ(i, 5);
+}
+
+TEST(BufReader, NumberErrorsInPlace) {
+  // With the default buffer every token is parsed in place.
+  StringReaderWriter inner("abc " + std::string(300, '1') + " 12abc 5");
+  BufReader br(inner);
+  int i = 7;
+  for (int k = 0; k < 3; k++)
+    EXPECT_EQ(br.read_into(i).error(), Err::InvalidData) << k;
+  EXPECT_EQ(i, 7);
+  ASSERT_TRUE(br.read_into(i).has_value());
+  EXPECT_EQ(i, 5);
+}
+
+TEST(BufReader, LongFloatLiteral) {
+  std::string literal = "0." + std::string(200, '0') + "25e201";
+  for (size_t capacity : {16, 4096}) {
+    StringReaderWriter inner(literal + " " + literal);
+    BufReader br(inner, capacity);
+    double a, b;
+    io::Expected<void> res = br >> a >> b;
+    ASSERT_TRUE(res.has_value()) << capacity;
+    EXPECT_DOUBLE_EQ(a, 2.5);
+    EXPECT_DOUBLE_EQ(b, 2.5);
+  }
+}
+
+TEST(FileReaderWriter, NumbersWithoutBuffer) {
+  FILE* f = std::tmpfile();
+  ASSERT_NE(f, nullptr);
+  std::fputs(" -42\t2.5e3 7", f);
+  std::rewind(f);
+  FileReaderWriter frw(f);
+  int a, c;
+  double b;
+  io::Expected<void> res = frw >> a >> b >> c;
+  ASSERT_TRUE(res.has_value());
+  EXPECT_EQ(a, -42);
+  EXPECT_DOUBLE_EQ(b, 2500);
+  EXPECT_EQ(c, 7);
+  std::fclose(f);
+}
+
+TEST(BufWriter, NumbersRoundTrip) {
+  StringReaderWriter inner;
+  std::vector<double> values{0.1, -1e-300, 1.7976931348623157e308, 3.0,
+                             1.0 / 3};
+  {
+    BufWriter bw(inner, 70);
+    for (int i = 0; i < 50; i++)
+      for (double v : values) {
+        io::Expected<void> res = bw << v * i << ' ' << -i << ' ';
+        ASSERT_TRUE(res.has_value());
+      }
+    io::Expected<void> res = bw << true << ' ' << uint64_t(-1);
+    ASSERT_TRUE(res.has_value());
+  }
+  for (int i = 0; i < 50; i++)
+    for (double v : values) {
+      double d;
+      int n;
+      io::Expected<void> res = inner >> d >> n;
+      ASSERT_TRUE(res.has_value());
+      EXPECT_EQ(d, v * i);
+      EXPECT_EQ(n, -i);
+    }
+  int b;
+  uint64_t u;
+  io::Expected<void> res = inner >> b >> u;
+  ASSERT_TRUE(res.has_value());
+  EXPECT_EQ(b, 1);
+  EXPECT_EQ(u, uint64_t(-1));
+}
+
+TEST(BufWriter, TinyBufferFallsBack) {
+  StringReaderWriter inner;
+  {
+    BufWriter bw(inner, 4);
+    io::Expected<void> res = bw << 0.5 << ' ' << 123456789;
+    ASSERT_TRUE(res.has_value());
+  }
+  std::string out;
+  std::string expected = "0.5 123456789";
+  out.resize(expected.size());
+  auto res = inner.read_exact(std::as_writable_bytes(std::span(out)));
+  ASSERT_TRUE(res.has_value());
+  EXPECT_EQ(out, expected);
+}
+
+TEST(BufWriter, WriteFmtAcrossFlushes) {
+  StringReaderWriter inner;
+  std::string expected;
+  {
+    BufWriter bw(inner, 16);
+    for (int i = 0; i < 100; i++) {
+      ASSERT_TRUE(bw.write_fmt("line {} of {}\n", i, "many").has_value());
+      expected += "line " + std::to_string(i) + " of many\n";
+    }
+  }
+  std::string out(expected.size(), '\0');
+  auto res = inner.read_exact(std::as_writable_bytes(std::span(out)));
+  ASSERT_TRUE(res.has_value());
+  EXPECT_EQ(out, expected);
+}
+
+TEST(StringReaderWriter, WriteFmtUnbuffered) {
+  StringReaderWriter srw;
+  std::string big(1000, 'x');
+  ASSERT_TRUE(srw.write_fmt("{}-{}", big, 7).has_value());
+  std::string out(1002, '\0');
+  auto res = srw.read_exact(std::as_writable_bytes(std::span(out)));
+  ASSERT_TRUE(res.has_value());
+  EXPECT_EQ(out, big + "-7");
+}
+
+namespace {
+// Records the size of every write call it receives.
+class CountingWriter : public Writer {
+public:
+  std::string data;
+  std::vector<size_t> calls;
+
+  Expected<size_t> write(std::span<const std::byte> buf) override {
+    return write_vectored(std::span(&buf, 1));
+  }
+  Expected<size_t>
+  write_vectored(std::span<const std::span<const std::byte>> bufs) override {
+    size_t total = 0;
+    for (auto buf : bufs) {
+      data.append(reinterpret_cast<const char*>(buf.data()), buf.size());
+      total += buf.size();
+    }
+    calls.push_back(total);
+    return total;
+  }
+  Expected<void> flush() override { return {}; }
+};
+} // namespace
+
+TEST(BufWriter, LargePayloadInOneVectoredWrite) {
+  CountingWriter inner;
+  BufWriter bw(inner, 64);
+  std::string header = "HDR:", body(1000, 'b');
+  ASSERT_TRUE(bw.write_all(std::as_bytes(std::span(header))).has_value());
+  ASSERT_TRUE(bw.write_all(std::as_bytes(std::span(body))).has_value());
+  ASSERT_TRUE(bw.flush().has_value());
+  EXPECT_EQ(inner.calls, std::vector<size_t>{1004});
+  EXPECT_EQ(inner.data, header + body);
+}
+
+TEST(BufWriter, WriteAllVectoredSmallSlices) {
+  CountingWriter inner;
+  std::string a = "ab", b = "", c = "cde";
+  {
+    BufWriter bw(inner, 64);
+    std::span<const std::byte> slices[] = {std::as_bytes(std::span(a)),
+                                           std::as_bytes(std::span(b)),
+                                           std::as_bytes(std::span(c))};
+    ASSERT_TRUE(bw.write_all_vectored(slices).has_value());
+    EXPECT_TRUE(inner.calls.empty());
+  }
+  EXPECT_EQ(inner.data, "abcde");
+}
+
+TEST(BufReader, ReadVectored) {
+  StringReaderWriter inner("0123456789");
+  BufReader br(inner, 8);
+  std::string x(3, '\0'), y(3, '\0');
+  std::span<std::byte> bufs[] = {std::as_writable_bytes(std::span(x)),
+                                 std::as_writable_bytes(std::span(y))};
+  auto n = br.read_vectored(bufs);
+  ASSERT_TRUE(n.has_value());
+  EXPECT_EQ(*n, 6);
+  EXPECT_EQ(x + y, "012345");
+  n = br.read_vectored(bufs);
+  ASSERT_TRUE(n.has_value());
+  EXPECT_EQ(*n, 2);
+  EXPECT_EQ(x.substr(0, 2), "67");
+
+  StringReaderWriter direct("abcdefgh");
+  n = direct.read_vectored(bufs);
+  ASSERT_TRUE(n.has_value());
+  EXPECT_EQ(*n, 6);
+  EXPECT_EQ(x + y, "abcdef");
+}
+
+TEST(FdReaderWriter, WriteReadPread) {
+  char path[] = "/tmp/io_fd_testXXXXXX";
+  int fd = ::mkstemp(path);
+  ASSERT_GE(fd, 0);
+  ::close(fd);
+  {
+    auto f = FdReaderWriter::open(path, O_WRONLY | O_TRUNC);
+    ASSERT_TRUE(f.has_value());
+    std::string head = "head:", body = "body";
+    std::span<const std::byte> slices[] = {std::as_bytes(std::span(head)),
+                                           std::as_bytes(std::span(body))};
+    ASSERT_TRUE(f->write_all_vectored(slices).has_value());
+  }
+  auto f = FdReaderWriter::open(path, O_RDONLY);
+  ASSERT_TRUE(f.has_value());
+  std::string out(4, '\0');
+  auto n = f->pread(std::as_writable_bytes(std::span(out)), 5);
+  ASSERT_TRUE(n.has_value());
+  EXPECT_EQ(out, "body");
+  std::string all(9, '\0');
+  auto res = f->read_exact(std::as_writable_bytes(std::span(all)));
+  ASSERT_TRUE(res.has_value());
+  EXPECT_EQ(all, "head:body");
+  n = f->read(std::as_writable_bytes(std::span(out)));
+  ASSERT_TRUE(n.has_value());
+  EXPECT_EQ(*n, 0);
+  ::unlink(path);
+}
+
+TEST(FdBufReaderWriter, Numbers) {
+  char path[] = "/tmp/io_fd_testXXXXXX";
+  int fd = ::mkstemp(path);
+  ASSERT_GE(fd, 0);
+  {
+    FdBufReaderWriter w(FdReaderWriter(fd, true), 64, 64);
+    for (int i = 0; i < 1000; i++)
+      ASSERT_TRUE(w.write_fmt("{} ", i * 3).has_value());
+  }
+  auto r = FdReaderWriter::open(path, O_RDONLY);
+  ASSERT_TRUE(r.has_value());
+  FdBufReaderWriter br(std::move(*r), 64, 64);
+  for (int i = 0; i < 1000; i++) {
+    int v;
+    ASSERT_TRUE(br.read_into(v).has_value());
+    EXPECT_EQ(v, i * 3);
+  }
+  ::unlink(path);
+}
+
+TEST(FdBufReaderWriter, FailedFinalFlush) {
+  // Writes to a read-only descriptor fail, so the flush on destruction
+  // leaves its bytes behind; the base must not retry them into the
+  // destroyed descriptor.
+  int fd = ::open("/dev/null", O_RDONLY);
+  ASSERT_GE(fd, 0);
+  {
+    FdBufReaderWriter w(FdReaderWriter(fd, true), 64, 64);
+    ASSERT_TRUE(w.write_fmt("{}", 42).has_value());
+    EXPECT_FALSE(w.flush().has_value());
+  }
+}
@@ -0,0 +1,182 @@
+#include "src/io/ioimpl.hpp"
+#include "src/io/ioplane.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+using namespace io;
+using plane::Point;
+using plane::Segment;
+
+static std::vector<Point> make_points(size_t n) {
+  std::vector<Point> points(n);
+  for (size_t i = 0; i < n; i++)
+    points[i] = Point{i * 0.5, -double(i)};
+  return points;
+}
+
+TEST(IoPlaneSuite, PointRoundTrip) {
+  StringReaderWriter srw;
+  const auto points = make_points(1000);
+  ASSERT_TRUE(srw.write_from(points).has_value());
+
+  std::vector<Point> out;
+  ASSERT_TRUE(srw.read_into(out).has_value());
+  EXPECT_EQ(out, points);
+}
+
+TEST(IoPlaneSuite, SegmentRoundTripBuffered) {
+  StringBufReaderWriter bufsrw("");
+  std::vector<Segment> segments{{Point{0, 0}, Point{1, 1}},
+                                {Point{2, 3}, Point{-4, 5}}};
+  io::Expected<void> res = bufsrw << segments;
+  ASSERT_TRUE(res.has_value());
+  bufsrw.flush();
+
+  std::vector<Segment> out;
+  res = bufsrw >> out;
+  ASSERT_TRUE(res.has_value());
+  EXPECT_EQ(out, segments);
+}
+
+TEST(IoPlaneSuite, SoA) {
+  StringReaderWriter srw;
+  PointsSoA soa;
+  for (int i = 0; i < 3000; i++)
+    soa.x.push_back(i), soa.y.push_back(2 * i);
+  ASSERT_TRUE(srw.write_from(soa).has_value());
+
+  std::vector<Point> aos;
+  ASSERT_TRUE(srw.read_into(aos).has_value());
+  ASSERT_EQ(aos.size(), 3000);
+  EXPECT_EQ(aos[1234], (Point{1234, 2468}));
+
+  StringReaderWriter again;
+  ASSERT_TRUE(again.write_from(aos).has_value());
+  PointsSoA back;
+  ASSERT_TRUE(again.read_into(back).has_value());
+  EXPECT_EQ(back.x, soa.x);
+  EXPECT_EQ(back.y, soa.y);
+}
+
+TEST(IoPlaneSuite, Chunked) {
+  StringReaderWriter srw;
+  auto writer = ArrayChunkWriter<Point>::open(srw, 10);
+  ASSERT_TRUE(writer.has_value());
+  auto points = make_points(10);
+  ASSERT_TRUE(writer->write(std::span(points).first(4)).has_value());
+  ASSERT_TRUE(writer->write(std::span(points).subspan(4)).has_value());
+  EXPECT_FALSE(writer->write(std::span(points).first(1)).has_value());
+  EXPECT_TRUE(writer->finish().has_value());
+
+  auto reader = ArrayChunkReader<Point>::open(srw);
+  ASSERT_TRUE(reader.has_value());
+  EXPECT_EQ(reader->remaining(), 10);
+  std::vector<Point> out;
+  Point chunk[3];
+  while (true) {
+    auto n = reader->read(chunk);
+    ASSERT_TRUE(n.has_value());
+    if (*n == 0)
+      break;
+    out.insert(out.end(), chunk, chunk + *n);
+  }
+  EXPECT_EQ(out, points);
+}
+
+// Accepts a fixed number of bytes, then reports zero written.
+class Limited : public Writer {
+  size_t room_;
+
+public:
+  explicit Limited(size_t room) : room_(room) {}
+  Expected<size_t> write(std::span<const std::byte> buf) override {
+    size_t n = std::min(buf.size(), room_);
+    room_ -= n;
+    return n;
+  }
+  Expected<void> flush() override { return {}; }
+};
+
+TEST(IoPlaneSuite, ChunkedShortOrFailed) {
+  StringReaderWriter srw;
+  auto writer = ArrayChunkWriter<Point>::open(srw, 10);
+  ASSERT_TRUE(writer.has_value());
+  auto points = make_points(10);
+  ASSERT_TRUE(writer->write(std::span(points).first(4)).has_value());
+  auto res = writer->finish();
+  ASSERT_FALSE(res.has_value());
+  EXPECT_EQ(res.error(), Err::InvalidData);
+
+  // A failed write leaves the count alone.
+  Limited limited(sizeof(BinaryArrayHeader) + 6 * sizeof(Point));
+  auto partial = ArrayChunkWriter<Point>::open(limited, 10);
+  ASSERT_TRUE(partial.has_value());
+  ASSERT_TRUE(partial->write(std::span(points).first(4)).has_value());
+  EXPECT_FALSE(partial->write(std::span(points).subspan(4)).has_value());
+  EXPECT_EQ(partial->remaining(), 6);
+  EXPECT_FALSE(partial->finish().has_value());
+}
+
+TEST(IoPlaneSuite, Errors) {
+  StringReaderWriter wrong_magic(std::string("XXXX\x10\0\0\0\5\0\0\0\0\0\0\0", 16));
+  std::vector<Point> out;
+  auto res = wrong_magic.read_into(out);
+  ASSERT_FALSE(res.has_value());
+  EXPECT_EQ(res.error(), Err::InvalidData);
+
+  StringReaderWriter srw;
+  ASSERT_TRUE(srw.write_from(make_points(5)).has_value());
+  std::vector<Segment> segments;
+  res = srw.read_into(segments);
+  ASSERT_FALSE(res.has_value());
+  EXPECT_EQ(res.error(), Err::InvalidData);
+
+  StringReaderWriter truncated;
+  ASSERT_TRUE(truncated.write_from(make_points(5)).has_value());
+  std::string bytes(16 + 3 * sizeof(Point), '\0');
+  ASSERT_TRUE(truncated.read_exact(std::as_writable_bytes(std::span(bytes))));
+  StringReaderWriter short_input(std::move(bytes));
+  res = short_input.read_into(out);
+  ASSERT_FALSE(res.has_value());
+  EXPECT_EQ(res.error(), Err::UnexpectedEof);
+}
+
+TEST(IoPlaneSuite, BogusCount) {
+  // A header claiming 2^60 points in front of three of them.
+  std::string bytes("PT2D\x10\0\0\0\0\0\0\0\0\0\0\x10", 16);
+  bytes.append(3 * sizeof(Point), '\0');
+  std::vector<Point> out;
+  StringReaderWriter as_vector{std::string(bytes)};
+  auto res = as_vector.read_into(out);
+  ASSERT_FALSE(res.has_value());
+  EXPECT_EQ(res.error(), Err::UnexpectedEof);
+
+  PointsSoA soa;
+  StringReaderWriter as_soa{std::string(bytes)};
+  res = as_soa.read_into(soa);
+  ASSERT_FALSE(res.has_value());
+  EXPECT_EQ(res.error(), Err::UnexpectedEof);
+}
+
+TEST(IoPlaneSuite, MappedFile) {
+  char path[] = "/tmp/ioplaneXXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  FILE* f = fdopen(fd, "w+");
+  auto points = make_points(5000);
+  {
+    FileBufReaderWriter frw(f);
+    ASSERT_TRUE(frw.write_from(points).has_value());
+  }
+  std::fclose(f);
+
+  auto mapped = MappedArray<Point>::open(path);
+  ASSERT_TRUE(mapped.has_value());
+  EXPECT_TRUE(std::equal(mapped->items().begin(), mapped->items().end(),
+                         points.begin(), points.end()));
+  EXPECT_FALSE(MappedArray<Segment>::open(path).has_value());
+  std::remove(path);
+  EXPECT_FALSE(MappedArray<Point>::open(path).has_value());
+}
@@ -0,0 +1,86 @@
+#include "src/io/iouring.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <unistd.h>
+
+using namespace io;
+
+namespace {
+struct TempPath {
+  char path[32] = "/tmp/io_uring_testXXXXXX";
+  TempPath() { ::close(::mkstemp(path)); }
+  ~TempPath() { ::unlink(path); }
+};
+
+class Uring : public testing::TestWithParam<bool> {
+protected:
+  // Small chunks so every test crosses many chunk boundaries.
+  UringOptions opts{4096, 4, GetParam()};
+};
+} // namespace
+
+TEST_P(Uring, NumbersRoundTrip) {
+  TempPath tmp;
+  {
+    auto w = UringWriter::open(tmp.path, opts);
+    ASSERT_TRUE(w.has_value());
+    for (int i = 0; i < 20000; i++)
+      ASSERT_TRUE(w->write_fmt("{} ", i * 7).has_value());
+    ASSERT_TRUE(w->flush().has_value());
+  }
+  auto r = UringReader::open(tmp.path, opts);
+  ASSERT_TRUE(r.has_value());
+  for (int i = 0; i < 20000; i++) {
+    int v;
+    ASSERT_TRUE(r->read_into(v).has_value());
+    EXPECT_EQ(v, i * 7);
+  }
+  int v;
+  EXPECT_FALSE(r->read_into(v).has_value());
+}
+
+TEST_P(Uring, BytesRoundTrip) {
+  TempPath tmp;
+  std::string data(100000, '\0');
+  for (size_t i = 0; i < data.size(); i++)
+    data[i] = static_cast<char>(i * 31 + i / 977);
+  {
+    auto w = UringWriter::open(tmp.path, opts);
+    ASSERT_TRUE(w.has_value());
+    auto bytes = std::as_bytes(std::span(data));
+    for (size_t i = 0; i < bytes.size(); i += 3000) {
+      io::Expected<void> res = w->write_all(
+          bytes.subspan(i, std::min<size_t>(3000, bytes.size() - i)));
+      ASSERT_TRUE(res.has_value());
+    }
+  }
+  auto r = UringReader::open(tmp.path, opts);
+  ASSERT_TRUE(r.has_value());
+  std::string out(data.size(), '\0');
+  io::Expected<void> res =
+      r->read_exact(std::as_writable_bytes(std::span(out)));
+  ASSERT_TRUE(res.has_value());
+  EXPECT_EQ(out, data);
+  char c;
+  auto n = r->read(std::as_writable_bytes(std::span(&c, 1)));
+  ASSERT_TRUE(n.has_value());
+  EXPECT_EQ(*n, 0);
+}
+
+TEST_P(Uring, EmptyFile) {
+  TempPath tmp;
+  auto r = UringReader::open(tmp.path, opts);
+  ASSERT_TRUE(r.has_value());
+  if (!GetParam()) {
+    EXPECT_FALSE(r->async());
+  }
+  auto buf = r->fill_buf();
+  ASSERT_TRUE(buf.has_value());
+  EXPECT_TRUE(buf->empty());
+}
+
+TEST(Uring, MissingFile) {
+  EXPECT_FALSE(UringReader::open("/nonexistent/io_uring_test").has_value());
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, Uring, testing::Bool());
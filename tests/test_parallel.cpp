@@ -0,0 +1,23 @@
+#include "src/parallel.hpp"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <vector>
+
+TEST(ParallelSuite, CoversRangeOnce) {
+  std::vector<std::atomic<int>> hits(1000);
+  lib::parallel_for(
+      hits.size(),
+      [&hits](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+          hits[i]++;
+      },
+      7);
+  for (auto& h : hits)
+    EXPECT_EQ(h.load(), 1);
+}
+
+TEST(ParallelSuite, EmptyRange) {
+  bool called = false;
+  lib::parallel_for(0, [&called](size_t, size_t) { called = true; });
+  EXPECT_FALSE(called);
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include "../src/plane.hpp"
+#include <cmath>
+#include <cstdint>
+#include <vector>
 
 using namespace plane;
 
@@ -50,6 +53,13 @@ TEST(VectorSuite, IsOrtogonalTest) {
     EXPECT_TRUE(u.isOrtogonal(v));
 }
 
+TEST(VectorSuite, CrossProductTest) {
+    Vector u{1.0, 2.0};
+    Vector v{3.0, 4.0};
+    EXPECT_EQ(u.cross(v), -2.0);
+    EXPECT_EQ(v.cross(u), 2.0);
+}
+
 TEST(VectorSuite, IsCollinearTest) {
     Vector u{2.0, 4.0};
     Vector v{1.0, 2.0};
@@ -85,3 +95,98 @@ TEST(LineTest, PerpendicularTest) {
     Line per = l.perpendicular(p);
     EXPECT_TRUE(l.direction.isOrtogonal(per.direction));
 }
+
+TEST(ScalarSuite, FloatVector) {
+    BasicVector<float> u{1.0f, 2.0f};
+    BasicVector<float> v{1.0f, 2.0f + 1e-6f};
+    EXPECT_TRUE(u == v);
+    EXPECT_EQ(sizeof(BasicPoint<float>), 2 * sizeof(float));
+}
+
+TEST(ScalarSuite, IntegerIsExact) {
+    BasicVector<int64_t> u{3, 4};
+    EXPECT_FALSE(u == (BasicVector<int64_t>{3, 5}));
+    EXPECT_TRUE(u.isOrtogonal(u.ortogonal()));
+    EXPECT_TRUE(u.isCollinear(BasicVector<int64_t>{6, 8}));
+}
+
+TEST(ScalarSuite, IntegerLineIntersection) {
+    BasicLine<int64_t> l1(BasicPoint<int64_t>{0, 0}, BasicPoint<int64_t>{1, 1});
+    BasicLine<int64_t> l2(BasicPoint<int64_t>{0, 1}, BasicPoint<int64_t>{1, 0});
+    auto result = l1.intersection(l2);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_DOUBLE_EQ(result->x, 0.5);
+    EXPECT_DOUBLE_EQ(result->y, 0.5);
+}
+
+TEST(ScalarSuite, Constexpr) {
+    constexpr Line l1(Point{0, 0}, Point{2, 2});
+    constexpr Line l2(Point{0, 2}, Point{2, 0});
+    constexpr auto p = l1.intersection(l2);
+    static_assert(p.has_value() && partial_eq(p->x, 1.0) && partial_eq(p->y, 1.0));
+    static_assert(l1.perpendicular(Point{1, 1}).direction.isOrtogonal(l1.direction));
+    static_assert(Tolerance<int>::eq(2, 2) && !Tolerance<int>::eq(2, 3));
+}
+
+TEST(SegmentSuite, Distance) {
+    Segment s{Point{0, 0}, Point{2, 0}};
+    EXPECT_DOUBLE_EQ(s.distance2(Point{1, 1}), 1.0);
+    EXPECT_DOUBLE_EQ(s.distance2(Point{3, 0}), 1.0);
+    EXPECT_DOUBLE_EQ(s.distance2(Point{-1, -1}), 2.0);
+    EXPECT_TRUE(s.line().direction.isCollinear(Vector{1, 0}));
+    Segment degenerate{Point{1, 1}, Point{1, 1}};
+    EXPECT_DOUBLE_EQ(degenerate.distance2(Point{1, 2}), 1.0);
+}
+
+TEST(ImplicitLineSuite, FromLine) {
+    ImplicitLine l(Line(Point{0, 1}, Point{2, 1}));
+    EXPECT_TRUE(partial_eq(l.value(Point{5, 3}), 2.0));
+    EXPECT_TRUE(partial_eq(l.value(Point{-5, 0}), -1.0));
+    EXPECT_TRUE(l.direction().isCollinear(Vector{1, 0}));
+    Line back = l.line();
+    EXPECT_TRUE(partial_eq(l.value(back.start), 0.0));
+}
+
+TEST(ImplicitLineSuite, Intersection) {
+    ImplicitLine l1(Line(Point{0, 0}, Point{1, 1}));
+    ImplicitLine l2(Line(Point{0, 1}, Point{1, 0}));
+    auto p = l1.intersection(l2);
+    ASSERT_TRUE(p.has_value());
+    EXPECT_EQ(*p, (Point{0.5, 0.5}));
+
+    ImplicitLine l3(Line(Point{1, 0}, Point{2, 1}));
+    EXPECT_TRUE(l1.isParallel(l3));
+    EXPECT_FALSE(l1.intersection(l3).has_value());
+
+    ImplicitLine per = l1.perpendicular(Point{2, 0});
+    EXPECT_TRUE(per.direction().isOrtogonal(l1.direction()));
+    EXPECT_TRUE(partial_eq(per.value(Point{2, 0}), 0.0));
+}
+
+TEST(ImplicitLineSuite, ManyVsOne) {
+    ImplicitLine base(Line(Point{0, 0}, Vector{1, 0}));
+    std::vector<ImplicitLine> others;
+    for (int i = 0; i < 100; i++)
+        others.push_back(ImplicitLine(Line(Point{double(i), 5}, Vector{1, double(i % 7) - 3})));
+    std::vector<Point> out(others.size());
+    base.intersection(others, out);
+    for (size_t i = 0; i < others.size(); i++) {
+        auto single = base.intersection(others[i]);
+        if (single) {
+            EXPECT_EQ(out[i], *single);
+        } else {
+            EXPECT_TRUE(std::isnan(out[i].x));
+        }
+    }
+
+    std::vector<Point> pts{{0, 2}, {3, -1}};
+    std::vector<double> dist(pts.size());
+    base.value(pts, dist);
+    EXPECT_DOUBLE_EQ(dist[0], 2.0);
+    EXPECT_DOUBLE_EQ(dist[1], -1.0);
+
+    EXPECT_THROW(base.intersection(others, std::span(out).first(99)),
+                 std::invalid_argument);
+    EXPECT_THROW(base.value(pts, std::span(dist).first(1)),
+                 std::invalid_argument);
+}
@@ -0,0 +1,83 @@
+#include "src/rtree.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace plane;
+
+static std::vector<Segment> random_segments(size_t n, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> coord(0, 1000), delta(-5, 5);
+  std::vector<Segment> segments(n);
+  for (auto& s : segments) {
+    Point a{coord(gen), coord(gen)};
+    s = Segment{a, Point{a.x + delta(gen), a.y + delta(gen)}};
+  }
+  return segments;
+}
+
+static std::vector<uint32_t> sorted(std::vector<uint32_t> ids) {
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+TEST(RTreeSuite, BoxBasics) {
+  Box a{0, 0, 2, 2}, b{1, 1, 3, 3}, c{5, 5, 6, 6};
+  EXPECT_TRUE(a.overlaps(b));
+  EXPECT_FALSE(a.overlaps(c));
+  EXPECT_FALSE(Box::empty().overlaps(a));
+  EXPECT_DOUBLE_EQ(a.distance2(Point{5, 6}), 25.0);
+  EXPECT_DOUBLE_EQ(a.distance2(Point{1, 1}), 0.0);
+}
+
+TEST(RTreeSuite, Empty) {
+  RTree<Box> tree(std::span<const Box>{});
+  EXPECT_TRUE(tree.empty());
+  EXPECT_TRUE(tree.query(Box{0, 0, 1, 1}).empty());
+  EXPECT_FALSE(tree.nearest(Point{0, 0}).has_value());
+}
+
+TEST(RTreeSuite, WindowQuery) {
+  auto segments = random_segments(10000, 1);
+  RTree<Segment> tree(segments, 4);
+  EXPECT_EQ(tree.size(), segments.size());
+
+  std::mt19937 gen(2);
+  std::uniform_real_distribution<double> coord(0, 1000);
+  std::vector<Box> windows;
+  for (int q = 0; q < 50; q++) {
+    double x = coord(gen), y = coord(gen);
+    windows.push_back(Box{x, y, x + 40, y + 25});
+  }
+  auto batch = tree.batch_query(windows, 3);
+  for (size_t q = 0; q < windows.size(); q++) {
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 0; i < segments.size(); i++)
+      if (bounding_box(segments[i]).overlaps(windows[q]))
+        expected.push_back(i);
+    EXPECT_EQ(sorted(tree.query(windows[q])), expected);
+    EXPECT_EQ(sorted(batch[q]), expected);
+  }
+}
+
+TEST(RTreeSuite, NearestSegment) {
+  auto segments = random_segments(5000, 3);
+  RTree<Segment> tree(segments);
+
+  std::mt19937 gen(4);
+  std::uniform_real_distribution<double> coord(-100, 1100);
+  std::vector<Point> points(100);
+  for (auto& p : points)
+    p = Point{coord(gen), coord(gen)};
+  auto batch = tree.batch_nearest(points, 4);
+  for (size_t q = 0; q < points.size(); q++) {
+    double best = segments[0].distance2(points[q]);
+    for (auto& s : segments)
+      best = std::min(best, s.distance2(points[q]));
+    auto id = tree.nearest(points[q]);
+    ASSERT_TRUE(id.has_value());
+    EXPECT_DOUBLE_EQ(segments[*id].distance2(points[q]), best);
+    EXPECT_EQ(batch[q], *id);
+  }
+}
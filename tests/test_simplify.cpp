@@ -0,0 +1,95 @@
+#include "src/io/ioimpl.hpp"
+#include "src/simplify.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <random>
+#include <vector>
+
+using namespace plane;
+
+static std::vector<Point> noisy_trace(size_t n, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::normal_distribution<double> noise(0, 0.01);
+  std::vector<Point> points(n);
+  for (size_t i = 0; i < n; i++) {
+    double t = i * 0.01;
+    points[i] = Point{t + noise(gen), std::sin(t) * 5 + noise(gen)};
+  }
+  return points;
+}
+
+static double max_deviation(const std::vector<Point>& original,
+                            const std::vector<Point>& simplified) {
+  double worst = 0;
+  for (auto& p : original) {
+    double best = INFINITY;
+    for (size_t i = 0; i + 1 < simplified.size(); i++)
+      best = std::min(best, Segment{simplified[i], simplified[i + 1]}.distance2(p));
+    worst = std::max(worst, best);
+  }
+  return std::sqrt(worst);
+}
+
+TEST(SimplifySuite, DouglasPeuckerLine) {
+  std::vector<Point> pts{{0, 0}, {1, 0.01}, {2, -0.01}, {3, 0}, {3, 1}, {3, 2}};
+  DouglasPeuckerSimplifier s(0.1);
+  std::vector<Point> out;
+  simplify(s, pts.begin(), pts.end(), std::back_inserter(out));
+  EXPECT_EQ(out, (std::vector<Point>{{0, 0}, {3, 0}, {3, 2}}));
+}
+
+TEST(SimplifySuite, VisvalingamLine) {
+  std::vector<Point> pts{{0, 0}, {1, 0.01}, {2, -0.01}, {3, 0}, {3, 1}, {3, 2}};
+  VisvalingamSimplifier s(0.1);
+  std::vector<Point> out;
+  simplify(s, pts.begin(), pts.end(), std::back_inserter(out));
+  EXPECT_EQ(out, (std::vector<Point>{{0, 0}, {3, 0}, {3, 2}}));
+}
+
+TEST(SimplifySuite, TinyInputs) {
+  DouglasPeuckerSimplifier s(1);
+  std::vector<Point> out;
+  auto emit = [&out](const Point& p) { out.push_back(p); };
+  s.finish(emit);
+  EXPECT_TRUE(out.empty());
+  s.push(Point{1, 2}, emit);
+  s.finish(emit);
+  EXPECT_EQ(out, (std::vector{Point{1, 2}}));
+}
+
+TEST(SimplifySuite, WindowedStreamBoundsError) {
+  auto trace = noisy_trace(5000, 1);
+  for (size_t window : {16, 100, 100000}) {
+    DouglasPeuckerSimplifier dp(0.05, window);
+    std::vector<Point> out;
+    simplify(dp, trace.begin(), trace.end(), std::back_inserter(out));
+    EXPECT_EQ(out.front(), trace.front());
+    EXPECT_EQ(out.back(), trace.back());
+    EXPECT_LT(out.size(), trace.size() / 10);
+    EXPECT_LE(max_deviation(trace, out), 0.05 + 1e-9);
+  }
+}
+
+TEST(SimplifySuite, VisvalingamReduces) {
+  auto trace = noisy_trace(5000, 2);
+  VisvalingamSimplifier vw(0.01, 256);
+  std::vector<Point> out;
+  simplify(vw, trace.begin(), trace.end(), std::back_inserter(out));
+  EXPECT_EQ(out.front(), trace.front());
+  EXPECT_EQ(out.back(), trace.back());
+  EXPECT_LT(out.size(), trace.size() / 5);
+  EXPECT_LT(max_deviation(trace, out), 0.2);
+}
+
+TEST(SimplifySuite, FromReader) {
+  io::StringReaderWriter srw("0 0\n1 0.01\n2 -0.01\n3 0\n3 1\n3 2\n");
+  DouglasPeuckerSimplifier s(0.1);
+  std::vector<Point> out;
+  auto res = simplify(s, srw, [&out](const Point& p) { out.push_back(p); });
+  ASSERT_TRUE(res.has_value());
+  EXPECT_EQ(out, (std::vector<Point>{{0, 0}, {3, 0}, {3, 2}}));
+
+  io::StringReaderWriter broken("0 0 1");
+  EXPECT_FALSE(simplify(s, broken, [](const Point&) {}).has_value());
+}
@@ -0,0 +1,131 @@
+#include "src/spatial_hash.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace plane;
+
+static std::vector<SpatialHash::Id>
+brute_force(const std::vector<Point>& points, const Point& c, double r) {
+  std::vector<SpatialHash::Id> result;
+  for (size_t i = 0; i < points.size(); i++) {
+    Vector d = points[i] - c;
+    if (d * d <= r * r)
+      result.push_back(i);
+  }
+  return result;
+}
+
+static std::vector<SpatialHash::Id> sorted(std::vector<SpatialHash::Id> ids) {
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+TEST(SpatialHashSuite, InsertQuery) {
+  SpatialHash grid(1.0);
+  auto a = grid.insert(Point{0.5, 0.5});
+  auto b = grid.insert(Point{1.5, 0.5});
+  grid.insert(Point{5.0, 5.0});
+  EXPECT_EQ(grid.size(), 3);
+  EXPECT_EQ(sorted(grid.query_radius(Point{1.0, 0.5}, 0.6)),
+            (std::vector{a, b}));
+  EXPECT_TRUE(grid.query_radius(Point{-3.0, -3.0}, 1.0).empty());
+}
+
+TEST(SpatialHashSuite, NegativeCoordinates) {
+  SpatialHash grid(2.0);
+  auto a = grid.insert(Point{-0.1, -0.1});
+  auto b = grid.insert(Point{0.1, 0.1});
+  EXPECT_EQ(sorted(grid.query_radius(Point{0, 0}, 0.5)), (std::vector{a, b}));
+}
+
+TEST(SpatialHashSuite, AliasedCells) {
+  // Cells 2^32 apart share a key; each point is still reported once.
+  SpatialHash grid(1.0);
+  double far = 4294967296.0;
+  auto a = grid.insert(Point{0.5, 0.5});
+  auto b = grid.insert(Point{far + 0.5, 0.5});
+  auto c = grid.insert(Point{0.5, far + 0.5});
+  EXPECT_EQ(sorted(grid.query_radius(Point{0.5, 0.5}, 1)),
+            (std::vector<SpatialHash::Id>{a}));
+  EXPECT_EQ(sorted(grid.query_radius(Point{far / 2, far / 2}, far)),
+            (std::vector<SpatialHash::Id>{a, b, c}));
+}
+
+TEST(SpatialHashSuite, MoveRemove) {
+  SpatialHash grid(1.0);
+  auto a = grid.insert(Point{0, 0});
+  auto b = grid.insert(Point{10, 10});
+  grid.move(a, Point{10.2, 10.2});
+  EXPECT_EQ(sorted(grid.query_radius(Point{10, 10}, 1)), (std::vector{a, b}));
+  EXPECT_TRUE(grid.query_radius(Point{0, 0}, 1).empty());
+
+  grid.remove(b);
+  EXPECT_FALSE(grid.contains(b));
+  EXPECT_EQ(grid.query_radius(Point{10, 10}, 1), std::vector{a});
+  EXPECT_EQ(grid.at(a), (Point{10.2, 10.2}));
+
+  auto c = grid.insert(Point{3, 3});
+  EXPECT_EQ(c, b);
+  EXPECT_EQ(grid.size(), 2);
+}
+
+TEST(SpatialHashSuite, RandomizedAgainstBruteForce) {
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> coord(-50, 50);
+  std::vector<Point> points(2000);
+  for (auto& p : points)
+    p = Point{coord(gen), coord(gen)};
+
+  SpatialHash grid(3.0);
+  for (auto& p : points)
+    grid.insert(p);
+  for (int step = 0; step < 500; step++) {
+    size_t i = gen() % points.size();
+    points[i] = Point{coord(gen), coord(gen)};
+    grid.move(i, points[i]);
+  }
+  grid.compact();
+
+  for (int q = 0; q < 50; q++) {
+    Point c{coord(gen), coord(gen)};
+    EXPECT_EQ(sorted(grid.query_radius(c, 7.5)), brute_force(points, c, 7.5));
+  }
+}
+
+TEST(SpatialHashSuite, ParallelRebuild) {
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<double> coord(-20, 20);
+  std::vector<Point> points(5000);
+  for (auto& p : points)
+    p = Point{coord(gen), coord(gen)};
+
+  SpatialHash grid(1.5);
+  grid.insert(Point{100, 100});
+  grid.rebuild(points, 4);
+  EXPECT_EQ(grid.size(), points.size());
+  for (size_t i = 0; i < points.size(); i += 97)
+    EXPECT_EQ(grid.at(i), points[i]);
+  for (int q = 0; q < 20; q++) {
+    Point c{coord(gen), coord(gen)};
+    EXPECT_EQ(sorted(grid.query_radius(c, 4)), brute_force(points, c, 4));
+  }
+
+  // Cells built in bulk must support removal and moves like linked ones.
+  for (size_t i = 0; i < points.size(); i++) {
+    if (i % 3 == 0) {
+      grid.remove(i);
+    } else if (i % 3 == 1) {
+      points[i] = Point{coord(gen), coord(gen)};
+      grid.move(i, points[i]);
+    }
+  }
+  for (int q = 0; q < 20; q++) {
+    Point c{coord(gen), coord(gen)};
+    std::vector<SpatialHash::Id> expected;
+    for (auto id : brute_force(points, c, 4))
+      if (id % 3 != 0)
+        expected.push_back(id);
+    EXPECT_EQ(sorted(grid.query_radius(c, 4)), expected);
+  }
+}
@@ -0,0 +1,79 @@
+#include "src/spatial_sort.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace plane;
+
+TEST(SpatialSortSuite, MortonKey) {
+  EXPECT_EQ(morton_key(0, 0), 0);
+  EXPECT_EQ(morton_key(1, 0), 1);
+  EXPECT_EQ(morton_key(0, 1), 2);
+  EXPECT_EQ(morton_key(3, 3), 15);
+  EXPECT_EQ(morton_key(0xFFFFFFFF, 0xFFFFFFFF), ~0ull);
+}
+
+TEST(SpatialSortSuite, HilbertCurveIsContinuous) {
+  std::vector<std::pair<uint64_t, std::pair<int, int>>> cells;
+  for (int x = 0; x < 16; x++)
+    for (int y = 0; y < 16; y++)
+      cells.push_back({hilbert_key(x, y), {x, y}});
+  std::sort(cells.begin(), cells.end());
+  for (size_t i = 0; i < cells.size(); i++) {
+    EXPECT_EQ(cells[i].first, i);
+    if (i > 0) {
+      auto [x0, y0] = cells[i - 1].second;
+      auto [x1, y1] = cells[i].second;
+      EXPECT_EQ(std::abs(x0 - x1) + std::abs(y0 - y1), 1);
+    }
+  }
+}
+
+TEST(SpatialSortSuite, RadixOrderIsStableSort) {
+  std::mt19937_64 gen(1);
+  std::vector<uint64_t> keys(100000);
+  for (auto& k : keys)
+    k = gen() % 1000 * 0x10000000001ull;
+  auto order = radix_order(keys, 4);
+  ASSERT_EQ(order.size(), keys.size());
+  for (size_t i = 1; i < order.size(); i++) {
+    ASSERT_LE(keys[order[i - 1]], keys[order[i]]);
+    if (keys[order[i - 1]] == keys[order[i]]) {
+      ASSERT_LT(order[i - 1], order[i]);
+    }
+  }
+  EXPECT_EQ(radix_order(keys, 1), order);
+}
+
+TEST(SpatialSortSuite, SortPoints) {
+  std::mt19937 gen(2);
+  std::uniform_real_distribution<double> coord(-1e3, 1e3);
+  std::vector<Point> points(50000);
+  for (auto& p : points)
+    p = Point{coord(gen), coord(gen)};
+
+  for (Curve curve : {Curve::Hilbert, Curve::Morton}) {
+    auto sorted = points;
+    spatial_sort(sorted, curve, 4);
+    auto keys = curve_keys(sorted, curve, 1);
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+
+    auto lex = [](const Point& a, const Point& b) {
+      return a.x < b.x || (a.x == b.x && a.y < b.y);
+    };
+    auto expected = points;
+    std::sort(expected.begin(), expected.end(), lex);
+    std::sort(sorted.begin(), sorted.end(), lex);
+    EXPECT_EQ(sorted, expected);
+  }
+}
+
+TEST(SpatialSortSuite, Degenerate) {
+  std::vector<Point> empty;
+  spatial_sort(empty);
+  std::vector<Point> same(10, Point{1, 1});
+  spatial_sort(same);
+  EXPECT_EQ(same, std::vector<Point>(10, Point{1, 1}));
+}
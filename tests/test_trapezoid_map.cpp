@@ -0,0 +1,134 @@
+#include "src/delaunay.hpp"
+#include "src/trapezoid_map.hpp"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace plane;
+
+// Segments directly above and below p by scanning all of them; p.x must
+// not coincide with an endpoint.
+static TrapezoidMap::Location brute_locate(const std::vector<Segment>& segs,
+                                           const Point& p) {
+  TrapezoidMap::Location loc{TrapezoidMap::npos, TrapezoidMap::npos};
+  double above = std::numeric_limits<double>::infinity(), below = -above;
+  for (uint32_t i = 0; i < segs.size(); i++) {
+    Point a = segs[i].a, b = segs[i].b;
+    if (a.x > b.x)
+      std::swap(a, b);
+    if (!(a.x < p.x && p.x < b.x))
+      continue;
+    double y = a.y + (b.y - a.y) * (p.x - a.x) / (b.x - a.x);
+    if (y > p.y && y < above)
+      above = y, loc.above = i;
+    if (y < p.y && y > below)
+      below = y, loc.below = i;
+  }
+  return loc;
+}
+
+static std::vector<Segment> delaunay_edges(size_t n, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> coord(0, 100);
+  std::vector<Point> pts(n);
+  for (auto& p : pts)
+    p = Point{coord(gen), coord(gen)};
+  Delaunay d(pts);
+  std::vector<Segment> segs;
+  auto& tris = d.triangles();
+  auto& half = d.halfedges();
+  for (uint32_t e = 0; e < tris.size(); e++)
+    if (half[e] == Delaunay::npos || half[e] < e)
+      segs.push_back({pts[tris[e]], pts[tris[Delaunay::next_halfedge(e)]]});
+  return segs;
+}
+
+static void expect_matches(const TrapezoidMap& map,
+                           const std::vector<Segment>& segs,
+                           const std::vector<Point>& queries) {
+  auto result = map.batch_locate(queries, 4);
+  for (size_t i = 0; i < queries.size(); i++) {
+    auto expected = brute_locate(segs, queries[i]);
+    EXPECT_EQ(result[i].above, expected.above) << i;
+    EXPECT_EQ(result[i].below, expected.below) << i;
+  }
+}
+
+TEST(TrapezoidMapSuite, Empty) {
+  TrapezoidMap map(std::vector<Segment>{});
+  auto loc = map.locate(Point{1, 2});
+  EXPECT_EQ(loc.above, TrapezoidMap::npos);
+  EXPECT_EQ(loc.below, TrapezoidMap::npos);
+}
+
+TEST(TrapezoidMapSuite, Triangle) {
+  std::vector<Segment> segs{
+      {{0, 0}, {4, 0}}, {{4, 0}, {2, 3}}, {{2, 3}, {0, 0}}};
+  TrapezoidMap map(segs);
+  auto inside = map.locate(Point{2, 1});
+  EXPECT_EQ(inside.above == 1 || inside.above == 2, true);
+  EXPECT_EQ(inside.below, 0u);
+  auto outside = map.locate(Point{2, 4});
+  EXPECT_EQ(outside.above, TrapezoidMap::npos);
+  EXPECT_EQ(map.locate(Point{1, -1}).above, 0u);
+}
+
+TEST(TrapezoidMapSuite, Grid) {
+  // Shared endpoints, equal x coordinates and vertical segments.
+  std::vector<Segment> segs;
+  for (int i = 0; i < 8; i++)
+    for (int j = 0; j < 8; j++) {
+      segs.push_back({{double(i), double(j)}, {double(i + 1), double(j)}});
+      segs.push_back({{double(i), double(j)}, {double(i), double(j + 1)}});
+    }
+  TrapezoidMap map(segs);
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<double> coord(-1, 9);
+  std::vector<Point> queries(2000);
+  for (auto& q : queries)
+    q = Point{coord(gen), coord(gen)};
+  expect_matches(map, segs, queries);
+}
+
+TEST(TrapezoidMapSuite, Triangulation) {
+  for (unsigned seed = 1; seed <= 3; seed++) {
+    auto segs = delaunay_edges(300, seed);
+    TrapezoidMap map(segs, seed);
+    EXPECT_EQ(map.size(), segs.size());
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> coord(-10, 110);
+    std::vector<Point> queries(2000);
+    for (auto& q : queries)
+      q = Point{coord(gen), coord(gen)};
+    expect_matches(map, segs, queries);
+  }
+}
+
+TEST(TrapezoidMapSuite, NearCollinear) {
+  // Triangulated points within 1e-12 of a line; inexact orientation tests
+  // walked off the map here.
+  std::mt19937_64 gen(1);
+  std::uniform_real_distribution<double> unit(0, 1);
+  std::vector<Point> pts(100000);
+  for (auto& p : pts) {
+    double t = unit(gen);
+    p = Point{t, 0.5 * t + 1e-12 * unit(gen)};
+  }
+  Delaunay d(pts);
+  std::vector<Segment> segs;
+  auto& tris = d.triangles();
+  auto& half = d.halfedges();
+  for (uint32_t e = 0; e < tris.size(); e++)
+    if (half[e] == Delaunay::npos || half[e] < e)
+      segs.push_back({pts[tris[e]], pts[tris[Delaunay::next_halfedge(e)]]});
+  TrapezoidMap map(segs);
+  EXPECT_EQ(map.size(), segs.size());
+  for (double x : {0.1, 0.5, 0.9}) {
+    auto high = map.locate(Point{x, 0.5 * x + 1});
+    EXPECT_EQ(high.above, TrapezoidMap::npos);
+    EXPECT_NE(high.below, TrapezoidMap::npos);
+    auto low = map.locate(Point{x, 0.5 * x - 1});
+    EXPECT_NE(low.above, TrapezoidMap::npos);
+    EXPECT_EQ(low.below, TrapezoidMap::npos);
+  }
+}